@@ -0,0 +1,121 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#endif
+
+namespace cuckoofilterbio1 {
+// Allocator policies decide how Table gets its memory. A policy has two
+// static methods:
+//   void *Allocate(size_t bytes, size_t alignment) - returns zeroed memory
+//                                  aligned to at least alignment bytes (a
+//                                  power of 2, or 0 for the policy's own) or
+//                                  throws std::bad_alloc
+//   void Deallocate(void *p, size_t bytes) - frees memory from Allocate
+
+// AlignedAllocator aligns the table to `alignment` bytes (a cache line by
+// default), or to the alignment asked for if that is larger, so a bucket of
+// 2^n bytes never straddles two cache lines. The memory is zeroed by the
+// allocating thread.
+template <size_t alignment = 64>
+class AlignedAllocator {
+  static_assert((alignment & (alignment - 1)) == 0 &&
+                    alignment >= sizeof(void *),
+                "alignment must be a power of 2 and at least sizeof(void *)");
+
+ public:
+  static void *Allocate(const size_t &bytes,
+                        const size_t &min_alignment = 0) {
+    const size_t align = std::max(alignment, min_alignment);
+    // aligned_alloc needs a size that is a multiple of the alignment
+    const size_t size = (bytes + align - 1) / align * align;
+    void *p = aligned_alloc(align, size == 0 ? align : size);
+    if (p == nullptr) throw std::bad_alloc();
+    memset(p, 0, size);
+    return p;
+  }
+
+  static void Deallocate(void *p, const size_t & /*bytes*/) { free(p); }
+};
+
+// MmapAllocator maps anonymous memory directly from the kernel. Pages are
+// page aligned and zeroed by the kernel when they are first touched, so the
+// constructor does not write the table and each page is placed on the NUMA
+// node of the thread that first uses it. With huge_pages, tables of at
+// least 2 MB are backed by explicit huge pages (MAP_HUGETLB) if any are
+// reserved, or else marked for transparent huge pages with
+// madvise(MADV_HUGEPAGE); this cuts TLB misses of multi-GB tables. The
+// mappings are aligned to pages, so an alignment above 4096 bytes is only
+// met by huge pages. On systems without mmap it falls back to
+// AlignedAllocator.
+template <bool huge_pages = false>
+class MmapAllocator {
+  static const size_t k_huge_page_size = 2 << 20;
+
+  // MappedSize returns length of the mapping for bytes; huge page mappings
+  // are rounded up to whole huge pages
+  static size_t MappedSize(const size_t &bytes) {
+    if (bytes == 0) return 1;
+    if (!huge_pages || bytes < k_huge_page_size) return bytes;
+    return (bytes + k_huge_page_size - 1) / k_huge_page_size *
+           k_huge_page_size;
+  }
+
+ public:
+  static void *Allocate(const size_t &bytes, const size_t &alignment = 0) {
+#if defined(__unix__) || defined(__APPLE__)
+    (void)alignment;
+    const size_t size = MappedSize(bytes);
+    const bool use_huge_pages = huge_pages && size >= k_huge_page_size;
+    void *p = MAP_FAILED;
+
+#if defined(MAP_HUGETLB)
+    if (use_huge_pages) {
+      p = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+               MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    }
+#endif
+    if (p == MAP_FAILED) {
+      p = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+               MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (p == MAP_FAILED) throw std::bad_alloc();
+#if defined(MADV_HUGEPAGE)
+      if (use_huge_pages) madvise(p, size, MADV_HUGEPAGE);
+#endif
+    }
+
+    return p;
+#else
+    return AlignedAllocator<>::Allocate(bytes, alignment);
+#endif
+  }
+
+  static void Deallocate(void *p, const size_t &bytes) {
+#if defined(__unix__) || defined(__APPLE__)
+    munmap(p, MappedSize(bytes));
+#else
+    AlignedAllocator<>::Deallocate(p, bytes);
+#endif
+  }
+};
+
+// AllocatorDeleter frees memory of allocator_type in a std::unique_ptr
+template <class allocator_type>
+class AllocatorDeleter {
+  size_t bytes;
+
+ public:
+  AllocatorDeleter(const size_t &bytes = 0) : bytes(bytes) {}
+
+  void operator()(void *p) const {
+    if (p != nullptr) allocator_type::Deallocate(p, bytes);
+  }
+};
+}  // namespace cuckoofilterbio1
@@ -1,9 +1,18 @@
+#pragma once
+
+#include <algorithm>
 #include <cmath>
+#include <iterator>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <vector>
 
+#include "eviction.h"
 #include "hash.h"
+#include "nthash.h"
+#include "stash.h"
 #include "table.h"
 
 namespace cuckoofilterbio1 {
@@ -12,10 +21,11 @@ enum Status {
   Ok = 0,
   NotFound = 1,
   NotEnoughSpace = 2,
+  NotSupported = 3,
 };
 
-// class Victim is used when there is no more space in a CF and there were
-// too many kickouts
+// class Victim describes an item that found no slot in the table after too
+// many kickouts and was put into the stash of a CF
 class Victim {
  public:
   uint32_t index;
@@ -23,59 +33,365 @@ class Victim {
   bool used;
 };
 
+// class HashedItem holds a fingerprint and both bucket indexes of an item. CFs
+// with the same bucket count and fingerprint size map an item to the same
+// HashedItem, so it can be computed once and used to probe all of them.
+class HashedItem {
+ public:
+  uint32_t fingerprint;
+  uint32_t index1;
+  uint32_t index2;
+};
+
+// RunThreads calls fn(t) for every t below num_threads, each on its own
+// thread (t = 0 on the calling one), and waits for all of them
+template <class function_type>
+void RunThreads(const size_t& num_threads, const function_type& fn) {
+  std::vector<std::thread> threads;
+  for (size_t t = 1; t < num_threads; t++) threads.emplace_back(fn, t);
+  fn(0);
+  for (std::thread& thread : threads) thread.join();
+}
+
+// PartitionByBucket copies count items to buffer ordered by the high bits of
+// the bucket index given by the member index, i.e. by which range of
+// 2^range_bits buckets they go to, with one counting-sort pass (an MSD radix
+// sort that stops at ranges small enough to stay in cache). Each of
+// num_threads threads counts and copies a slice of items. Returns where each
+// range starts in buffer, followed by count.
+inline std::vector<size_t> PartitionByBucket(
+    const HashedItem* items, HashedItem* buffer, const size_t& count,
+    uint32_t HashedItem::*index, const size_t& index_bits,
+    const size_t& range_bits, const size_t& num_threads = 1) {
+  const size_t ranges = 1ULL << (index_bits - range_bits);
+  // offsets[t * ranges + r] is where thread t copies its next item of range r
+  std::vector<size_t> offsets(num_threads * ranges, 0);
+
+  RunThreads(num_threads, [&](const size_t& t) {
+    size_t* thread_offsets = offsets.data() + t * ranges;
+    for (size_t i = count * t / num_threads;
+         i < count * (t + 1) / num_threads; i++)
+      thread_offsets[(items[i].*index) >> range_bits]++;
+  });
+
+  std::vector<size_t> range_starts(ranges + 1);
+  size_t offset = 0;
+  for (size_t r = 0; r < ranges; r++) {
+    range_starts[r] = offset;
+    for (size_t t = 0; t < num_threads; t++) {
+      const size_t thread_count = offsets[t * ranges + r];
+      offsets[t * ranges + r] = offset;
+      offset += thread_count;
+    }
+  }
+  range_starts[ranges] = offset;
+
+  RunThreads(num_threads, [&](const size_t& t) {
+    size_t* thread_offsets = offsets.data() + t * ranges;
+    for (size_t i = count * t / num_threads;
+         i < count * (t + 1) / num_threads; i++)
+      buffer[thread_offsets[(items[i].*index) >> range_bits]++] = items[i];
+  });
+
+  return range_starts;
+}
+
+// Bytes of the table that BuildHashed fills from one partition of items
+const size_t build_range_bytes = 256 << 10;
+
 // Max limit of how much kickouts can happen in an Add method
 const size_t max_num_kicks = 500;
 
+// Number of items a CF keeps in its stash by default
+const size_t default_stash_size = 4;
+
+// Number of items that batch methods hash and prefetch before probing them
+const size_t batch_window = 16;
+
+// Bucket layouts decide where the alternate bucket of an item is. A layout
+// is constructed with the number of bits in a bucket and the bucket count,
+// and AltIndex must give back index when applied twice. k_alignment is the
+// alignment in bytes the layout needs of the table (0 for none). AltIndex only
+// changes the bits of index in index_mask, the bucket count the CF was
+// created with, so both buckets of an item stay in the same part of a CF
+// that was expanded.
+
+// FullRangeLayout places the alternate bucket anywhere in the table, so a
+// lookup usually touches two cache lines (default)
+class FullRangeLayout {
+ public:
+  static constexpr size_t k_alignment = 0;
+
+  FullRangeLayout(const size_t& /*bits_per_bucket*/ = 0,
+                  const size_t& /*bucket_count*/ = 0) {}
+
+  // AltIndex calculates the other bucket of a fingerprint (partial-key cuckoo
+  // hashing). Bucket count is a power of 2, so masking replaces the modulo.
+  uint32_t AltIndex(const uint32_t& index, const uint32_t& fingerprint,
+                    const uint32_t& index_mask) const {
+    return index ^ ((fingerprint * 0x5bd1e995) & index_mask);
+  }
+};
+
+// BlockedLayout keeps the alternate bucket inside the same aligned block of
+// block_bytes bytes (a cache line by default, or e.g. 4096 for a page), like
+// Morton and vacuum filters, so most lookups cost one cache or TLB miss.
+// Items can only move within their block, so the table fills up at a lower
+// load factor than with FullRangeLayout. A block holds a power of 2 of at
+// least 2 buckets. The CF asks the table for an alignment of block_bytes (at
+// least a cache line), so blocks start at multiples of block_bytes if a
+// bucket is a power of 2 bytes; with bit-packed tables a block may straddle
+// two. MmapAllocator only aligns to pages, or to huge pages if the table is
+// backed by them.
+template <size_t block_bytes = 64>
+class BlockedLayout {
+  uint32_t block_mask;
+
+ public:
+  static constexpr size_t k_alignment = std::max<size_t>(block_bytes, 64);
+
+  BlockedLayout(const size_t& bits_per_bucket = 0,
+                const size_t& bucket_count = 0)
+      : block_mask(0) {
+    size_t buckets_per_block = 2;
+    while (bits_per_bucket > 0 &&
+           2 * buckets_per_block * bits_per_bucket <= 8 * block_bytes)
+      buckets_per_block *= 2;
+    if (buckets_per_block > bucket_count) buckets_per_block = bucket_count;
+    if (buckets_per_block > 0) block_mask = buckets_per_block - 1;
+  }
+
+  // AltIndex XORs the position of index inside its block with an offset from
+  // 1 to block_mask derived from the fingerprint, so both buckets differ
+  uint32_t AltIndex(const uint32_t& index, const uint32_t& fingerprint,
+                    const uint32_t& /*index_mask*/) const {
+    if (block_mask == 0) return index;
+    const uint32_t h = fingerprint * 0x5bd1e995;
+    return index ^ (1 + (uint32_t)(((uint64_t)h * block_mask) >> 32));
+  }
+
+  // BucketsPerBlock returns number of buckets in a block
+  size_t BucketsPerBlock() const { return block_mask + 1; }
+};
+
 // class CuckooFilter contains a reference to one table
 // unitx - size of a fingerprint; uint8_t (default), uint16_t, uint32_t
 // item_type - type of a items that will be added to a CuckooFilter (std::string
 // by defualt) class table_type - table class that will be used for storing
-// items hash_used - class used for calculating a hash for an item (uses ()
+// items; fingerprint size is taken from table_type::k_bits_per_item, so
+// BitPackedTable<bits> can be used for any size from 4 to 32 bits, and the
+// number of slots per bucket from table_type::k_items_per_bucket, e.g.
+// Table<uint8_t, 8> for 8-slot buckets
+// hash_used - class used for calculating a hash for an item (uses ()
 // operator)
+// layout_type - where the alternate bucket is; FullRangeLayout (default) or
+// BlockedLayout<block_bytes>
+// eviction_type - how items are moved when both buckets are full;
+// RandomWalkEviction<max_num_kicks> (default) or BreadthFirstEviction<>
 template <typename uintx = uint8_t, typename item_type = std::string,
-          class table_type = Table<uintx>, typename hash_used = Hash>
+          class table_type = Table<uintx>, typename hash_used = Hash,
+          class layout_type = FullRangeLayout,
+          class eviction_type = RandomWalkEviction<max_num_kicks>>
 class CuckooFilter {
   std::unique_ptr<table_type> table;
   size_t num_items;
   size_t max_items;
   size_t bits_per_item;
 
-  Victim victim;
+  Stash stash;
 
   hash_used hasher;
   uint32_t item_mask;
+  uint32_t index_mask;
+  layout_type layout;
+
+  // Expand doubles the bucket count and moves one fingerprint bit into the
+  // bucket index. base_mask and base_bits describe the bucket count the CF
+  // was created with.
+  uint32_t base_mask;
+  size_t base_bits;
+  size_t expansions;
+  size_t max_expansions;
+
+  eviction_type eviction;
+  size_t num_kicks;
+  // Bucket whose free slot the last added item (or the item it moved) took,
+  // or the bucket of the item that was stashed instead
+  uint32_t filled_bucket;
+
+  // SplitHash splits a 64-bit hash of an item into the first index (low bits)
+  // and a fingerprint (high bits). After Expand, the low fingerprint bits
+  // give the high bits of the index, one bit per expansion, and the rest of
+  // the bits are stored.
+  void SplitHash(const uint64_t& hash, uint32_t& index, uint32_t& fingerprint) {
+    uint64_t fingerprint_bits = (hash >> 32) & item_mask;
+    // Fingerprint 0 marks an empty slot in the table. The bits above
+    // max_expansions are never moved into the index, so they must not be 0.
+    if ((fingerprint_bits >> max_expansions) == 0)
+      fingerprint_bits |= 1ULL << max_expansions;
+
+    index = (hash & base_mask) |
+            ((fingerprint_bits & ((1ULL << expansions) - 1)) << base_bits);
+    fingerprint = fingerprint_bits >> expansions;
+  }
 
-  // GenerateFingerprint will generate a fingerprint for an item
-  uint32_t GenerateFingerprint(const item_type& item) {
-    return hasher(item) & item_mask;
+  // ReinsertStashed moves the last stashed item back into the table after a
+  // delete made room. The item is already counted in num_items and AddImpl
+  // counts it again, so it is uncounted first.
+  void ReinsertStashed() {
+    uint32_t index, fingerprint;
+    stash.Back(index, fingerprint);
+    stash.PopBack();
+    num_items--;
+    AddImpl(index, fingerprint);
   }
 
-  // GenerateFingerprint will calculate first index for an item
-  uint32_t GetIndex1(const item_type& item) {
-    return hasher(item) % (table->BucketCount());
+  // PathNode is a bucket on a cuckoo path and the fingerprint that moves
+  // into it from the previous bucket of the path
+  class PathNode {
+   public:
+    uint32_t index;
+    uint32_t fingerprint;
+  };
+
+  // MovePath checks that every fingerprint of path is still in the previous
+  // bucket of the path, then moves them one bucket further, starting from
+  // the last bucket, which has a free slot, and stores the first fingerprint
+  // in the first bucket. Returns false if the path is stale.
+  bool MovePath(const std::vector<PathNode>& path) {
+    const size_t k_items_per_bucket = table_type::k_items_per_bucket;
+    uint32_t old_fingerprint = 0;
+
+    for (size_t k = 1; k < path.size(); k++) {
+      bool found = false;
+      for (uint32_t j = 0; j < k_items_per_bucket && !found; j++)
+        found = table->ReadItem(path[k - 1].index, j) == path[k].fingerprint;
+      if (!found) return false;
+    }
+
+    for (size_t k = path.size() - 1; k > 0; k--) {
+      table->InsertItemToBucket(path[k].index, path[k].fingerprint, false,
+                                old_fingerprint);
+      table->DeleteItemFromBucket(path[k - 1].index, path[k].fingerprint);
+    }
+    table->InsertItemToBucket(path[0].index, path[0].fingerprint, false,
+                              old_fingerprint);
+    num_kicks += path.size() - 1;
+
+    return true;
   }
 
-  // GenerateFingerprint will calculate second index for an item based on the
-  // first index and the fingerptint
+  // PlaceByRandomWalks adds count items whose buckets were both full. A
+  // random walk of a single item is a chain of dependent cache misses, so
+  // up to batch_window walks are run round-robin, each prefetching the next
+  // bucket of its path. A walk only reads the table while it looks for a
+  // bucket with a free slot, avoiding buckets already on its path, and then
+  // moves the items with MovePath (starting over if another walk changed
+  // the path in the meantime). An item whose walk takes more than
+  // max_num_kicks steps is not added, so nothing is lost and nothing is
+  // stashed. The items that were not added are moved to the front of items and
+  // their number is returned.
+  size_t PlaceByRandomWalks(HashedItem* items, const size_t& count) {
+    const size_t k_items_per_bucket = table_type::k_items_per_bucket;
+    HashedItem walk_items[batch_window];
+    std::vector<PathNode> paths[batch_window];
+    size_t steps[batch_window];
+    bool active[batch_window];
+    size_t next = 0, overflow = 0, num_active = 0;
+
+    // Start begins a walk for the next item at one of its buckets
+    auto start = [&](const size_t& w) {
+      active[w] = next < count;
+      if (!active[w]) return;
+      walk_items[w] = items[next++];
+      const HashedItem& item = walk_items[w];
+      paths[w].assign(
+          1, {rand() & 1 ? item.index1 : item.index2, item.fingerprint});
+      steps[w] = 0;
+      table->Prefetch(paths[w][0].index);
+      num_active++;
+    };
+
+    for (size_t w = 0; w < batch_window; w++) start(w);
+
+    while (num_active > 0) {
+      for (size_t w = 0; w < batch_window; w++) {
+        if (!active[w]) continue;
+        std::vector<PathNode>& path = paths[w];
+        const uint32_t bucket = path.back().index;
+
+        uint32_t bucket_items[k_items_per_bucket];
+        bool free_slot = false;
+        for (uint32_t j = 0; j < k_items_per_bucket; j++) {
+          bucket_items[j] = table->ReadItem(bucket, j);
+          free_slot |= bucket_items[j] == 0;
+        }
+
+        if (free_slot || ++steps[w] > max_num_kicks ||
+            num_items == max_items || stash.Full()) {
+          if (!free_slot || num_items == max_items || stash.Full()) {
+            items[overflow++] = walk_items[w];
+          } else if (MovePath(path)) {
+            num_items++;
+          } else {
+            path.resize(1);
+            table->Prefetch(path[0].index);
+            continue;
+          }
+          num_active--;
+          start(w);
+          continue;
+        }
+
+        const uint32_t fingerprint = bucket_items[rand() % k_items_per_bucket];
+        const uint32_t alt = GetIndex2(bucket, fingerprint);
+        bool on_path = false;
+        for (const PathNode& node : path) on_path |= node.index == alt;
+        if (on_path) continue;
+
+        path.push_back({alt, fingerprint});
+        table->Prefetch(alt);
+      }
+    }
+
+    return overflow;
+  }
+
+  // GetIndex2 will calculate second index for an item based on the first index
+  // and the fingerprint with layout_type. Applying it to the second index
+  // gives back the first one. Only the fingerprint bits that Expand never
+  // moves into the index are used, so that an item moved by Expand is still
+  // in one of its two buckets.
   uint32_t GetIndex2(const uint32_t& index1, const uint32_t& fingerprint) {
-    std::string s = std::to_string(fingerprint);
-    return (index1 ^ hasher(s)) % (table->BucketCount());
+    return layout.AltIndex(index1, fingerprint >> (max_expansions - expansions),
+                           base_mask);
   }
 
  public:
   // CuckooFilter constructor takes max_items as an argument and will create an
-  // empty CF
-  CuckooFilter(const size_t max_items)
-      : max_items(max_items), num_items(0), victim(), hasher() {
-    if (std::is_same<uintx, uint8_t>::value) {
-      bits_per_item = 8;
-    } else if (std::is_same<uintx, uint16_t>::value) {
-      bits_per_item = 16;
-    } else if (std::is_same<uintx, uint32_t>::value) {
-      bits_per_item = 32;
-    }
-
-    size_t k_items_per_bucket = 4;
+  // empty CF. max_expansions is how many times Expand can double it (at most
+  // bits_per_item - 1); the default 0 keeps all fingerprint bits for the
+  // alternate bucket. stash_size (at least 1) is how many items that found
+  // no slot the CF keeps before Add fails. fingerprint_bits, if not 0, keeps
+  // only that many bits of every fingerprint (at most the slot width
+  // table_type::k_bits_per_item); the FPP is then that of the narrower
+  // fingerprint while the table stays the same size.
+  CuckooFilter(const size_t max_items, const size_t& max_expansions = 0,
+               const size_t& stash_size = default_stash_size,
+               const size_t& fingerprint_bits = 0)
+      : num_items(0),
+        max_items(max_items),
+        stash(std::max<size_t>(stash_size, 1)),
+        hasher(),
+        expansions(0),
+        eviction(),
+        num_kicks(0),
+        filled_bucket(0) {
+    bits_per_item = table_type::k_bits_per_item;
+    if (fingerprint_bits > 0)
+      bits_per_item = std::min(fingerprint_bits, bits_per_item);
+
+    const size_t k_items_per_bucket = table_type::k_items_per_bucket;
     item_mask = (1ULL << bits_per_item) - 1;
 
     // Number of buckets needs to be power of 2 so here next power of 2
@@ -84,126 +400,445 @@ class CuckooFilter {
             ? 1
             : pow(2, ceil(log2(((double)max_items) / k_items_per_bucket)));
 
-    victim.used = false;
+    index_mask = num_buckets - 1;
+    layout = layout_type(table_type::k_bits_per_item * k_items_per_bucket,
+                         num_buckets);
 
-    table = std::make_unique<table_type>(num_buckets);
+    base_mask = index_mask;
+    base_bits = log2(num_buckets);
+    this->max_expansions =
+        std::min({max_expansions, bits_per_item - 1, 32 - base_bits});
+
+    table = std::make_unique<table_type>(num_buckets, layout_type::k_alignment);
   }
 
   // CuckooFilter destructor
   virtual ~CuckooFilter() = default;
 
-  // Method Add will check if there is room to add an item and if the victim is
-  // not in use. If both conditions are satisified, method will create first
+  // A CF can be moved (the table is not copied), so CFs can be stored by
+  // value in a std::vector
+  CuckooFilter(CuckooFilter&&) = default;
+  CuckooFilter& operator=(CuckooFilter&&) = default;
+
+  // Method Add will check if there is room to add an item and if the stash is
+  // not full. If both conditions are satisified, method will create first
   // index and a fingerprint for an item. Then, it will 100% add an item in the
   // CF.
-  Status Add(const item_type& item) {
-    if (num_items == max_items) return NotEnoughSpace;
+  Status Add(const item_type& item) { return AddHash(hasher(item)); }
+
+  // Add, Contain and Delete also accept other keys that hash_used can hash
+  // without building an item_type, e.g. std::string_view, (const char*, size_t)
+  // or fixed-width integers with the default Hash. Such a key must hash the
+  // same as the equivalent item_type.
+  template <typename Key>
+  Status Add(const Key& key) {
+    return AddHash(hasher(key));
+  }
+
+  Status Add(const char* data, const size_t& len) {
+    return AddHash(hasher(data, len));
+  }
+
+  // AddBatch adds count keys and writes the status of each into out. Like
+  // ContainBatch, keys are hashed and both of their buckets prefetched a
+  // window of batch_window keys ahead of the inserts.
+  template <typename Key>
+  void AddBatch(const Key* keys, const size_t& count, Status* out) {
+    HashedItem hashed[batch_window];
+
+    for (size_t start = 0; start < count; start += batch_window) {
+      const size_t window = std::min(batch_window, count - start);
+
+      for (size_t i = 0; i < window; i++) {
+        hashed[i] = GetHashedItem(hasher(keys[start + i]));
+        PrefetchHashedItem(hashed[i]);
+      }
+      for (size_t i = 0; i < window; i++)
+        out[start + i] = AddHashedItem(hashed[i]);
+    }
+  }
+
+  // Build adds all keys of a range (any container of item_type or of other
+  // keys hash_used can hash). It is much faster than calling Add for every
+  // key of a large set: see BuildHashed. With num_threads above 1 the keys
+  // are hashed and placed by that many threads, which needs hash_used to be
+  // callable from several threads at once. Returns NotEnoughSpace if some
+  // keys could not be added.
+  template <typename Range>
+  Status Build(const Range& keys, const size_t& num_threads = 1) {
+    const size_t count = std::distance(std::begin(keys), std::end(keys));
+    std::unique_ptr<HashedItem[]> hashed(new HashedItem[count]);
+    HashKeys(keys, hashed.get(), num_threads);
+
+    return BuildHashed(hashed.get(), count, num_threads) == 0 ? Ok
+                                                              : NotEnoughSpace;
+  }
+
+  // HashKeys writes the HashedItem of every key of a range to out, using
+  // num_threads threads that each hash a slice of the range
+  template <typename Range>
+  void HashKeys(const Range& keys, HashedItem* out,
+                const size_t& num_threads = 1) {
+    const size_t count = std::distance(std::begin(keys), std::end(keys));
+
+    RunThreads(num_threads, [&](const size_t& t) {
+      const size_t begin = count * t / num_threads;
+      const size_t end = count * (t + 1) / num_threads;
+      auto key = std::next(std::begin(keys), begin);
+      for (size_t i = begin; i < end; i++, ++key)
+        out[i] = GetHashedItem(hasher(*key));
+    });
+  }
+
+  // BuildHashed adds count prehashed items. Items are partitioned by the
+  // range of build_range_bytes of the table their first bucket is in and
+  // stored there while there is a free slot (PlaceInBuckets), so each
+  // partition only touches a part of the table that stays in cache. The
+  // items that did not fit are partitioned by their second bucket and stored
+  // there the same way, and only the ones left after that are added with
+  // kickouts by PlaceByRandomWalks on the calling thread, and the few no
+  // walk could place with AddHashedItem. Partitioning and placing use
+  // num_threads threads. items is reordered; the items that could not be
+  // added, because the CF is full or its stash is full, are moved to its
+  // front and their number is returned.
+  size_t BuildHashed(HashedItem* items, const size_t& count,
+                     const size_t& num_threads = 1) {
+    if (stash.Full()) return count;
+
+    // the items that would not fit even into a perfectly packed table are
+    // left at the front without trying them
+    const size_t room = max_items - num_items;
+    const size_t excess = count > room ? count - room : 0;
+    HashedItem* placed = items + excess;
+    size_t left = count - excess;
+
+    std::unique_ptr<HashedItem[]> buffer(new HashedItem[left]);
+    const size_t index_bits = log2(index_mask + 1.0);
+    const size_t bucket_bytes =
+        std::max<size_t>(table->SizeInBytes() >> index_bits, 1);
+    // at most 4096 partitions, so that writing them stays within the TLB
+    size_t range_bits = index_bits > 12 ? index_bits - 12 : 0;
+    while (range_bits < index_bits &&
+           (bucket_bytes << (range_bits + 1)) <= build_range_bytes)
+      range_bits++;
+
+    for (uint32_t HashedItem::*index :
+         {&HashedItem::index1, &HashedItem::index2}) {
+      std::vector<size_t> range_starts =
+          PartitionByBucket(placed, buffer.get(), left, index, index_bits,
+                            range_bits, num_threads);
+      left = PlaceInBuckets(buffer.get(), placed, range_starts, index,
+                            num_threads);
+    }
+
+    left = excess + PlaceByRandomWalks(placed, left);
+
+    // the items no walk could place are added like Add does, so they may
+    // end up in the stash
+    while (left > 0 && AddHashedItem(items[left - 1]) == Ok) left--;
 
-    if (victim.used) return NotEnoughSpace;
+    return left;
+  }
+
+  // PlaceInBuckets stores the items of partitioned, which PartitionByBucket
+  // ordered by range_starts, in the bucket given by the member index if it
+  // has a free slot. The ranges are split into two blocks per thread; the
+  // threads fill the even blocks and then the odd ones, so no two threads
+  // ever write next to each other (buckets of a BitPackedTable share bytes).
+  // The items that did not fit are copied to the front of overflow and
+  // their number is returned.
+  size_t PlaceInBuckets(const HashedItem* partitioned, HashedItem* overflow,
+                        const std::vector<size_t>& range_starts,
+                        uint32_t HashedItem::*index,
+                        const size_t& num_threads) {
+    const size_t ranges = range_starts.size() - 1;
+    size_t blocks = std::min(2 * num_threads, ranges);
+    // a block must be wider than a table access that straddles buckets
+    if (table->SizeInBytes() / blocks < 64) blocks = 1;
+    std::vector<size_t> block_overflow(blocks, 0), block_placed(blocks, 0);
+
+    auto fill = [&](const size_t& b) {
+      const size_t begin = range_starts[ranges * b / blocks];
+      const size_t end = range_starts[ranges * (b + 1) / blocks];
+      uint32_t old_fingerprint = 0;
+      size_t placed = 0, not_placed = 0;
+
+      for (size_t i = begin; i < end; i++) {
+        if (table->InsertItemToBucket(partitioned[i].*index,
+                                      partitioned[i].fingerprint, false,
+                                      old_fingerprint)) {
+          placed++;
+        } else {
+          overflow[begin + not_placed++] = partitioned[i];
+        }
+      }
+      block_placed[b] = placed;
+      block_overflow[b] = not_placed;
+    };
+
+    for (size_t parity = 0; parity < 2; parity++) {
+      RunThreads((blocks + 1 - parity) / 2, [&](const size_t& t) {
+        if (2 * t + parity < blocks) fill(2 * t + parity);
+      });
+    }
+
+    size_t left = 0;
+    for (size_t b = 0; b < blocks; b++) {
+      const HashedItem* block = overflow + range_starts[ranges * b / blocks];
+      std::copy(block, block + block_overflow[b], overflow + left);
+      left += block_overflow[b];
+      num_items += block_placed[b];
+    }
+
+    return left;
+  }
 
-    uint32_t index = GetIndex1(item);
-    uint32_t fingerprint = GenerateFingerprint(item);
+  // AddHashedItem adds a prehashed item to the CF
+  Status AddHashedItem(const HashedItem& hashed) {
+    if (IsFull()) return NotEnoughSpace;
+
+    return AddImpl(hashed.index1, hashed.fingerprint);
+  }
+
+  // AddHash adds an item given by its 64-bit hash (as returned by hash_used)
+  Status AddHash(const uint64_t& hash) {
+    if (IsFull()) return NotEnoughSpace;
+
+    uint32_t index, fingerprint;
+    SplitHash(hash, index, fingerprint);
 
     return AddImpl(index, fingerprint);
   }
 
-  // Method AddImpl will try to add an item to a bucket[index]. If there is no
-  // space left, will calculate alternate index and will try to add it to
-  // bucket[index2]. If there is no space left on this bucket too, kickout will
-  // occure. Once kickout occures, alternate index is calculated for a kickouted
-  // item and the whole adding process will be repeated.
-  // In order to prevent continous loop, max_num_kicks will limit the number of
-  // kickouts. Once the limit is exceeded, victim will be used. Victim will hold
-  // the last kickout value and will prevent further adding to the CF. Victim
-  // can become unused once one item is deleted from the CF.
+  // Method AddImpl will try to add an item to a bucket[index] or to its
+  // alternate bucket. If both are full, eviction_type moves other items to
+  // their alternate buckets to make room. If it gives up, the item that was
+  // left without a slot goes into the stash. Once the stash is full, no
+  // more items can be added until one is deleted from the CF.
   Status AddImpl(const uint32_t& index, const uint32_t& fingerprint) {
+    if (stash.Full()) return NotEnoughSpace;
+
     uint32_t current_index = index;
     uint32_t current_fingerprint = fingerprint;
-    uint32_t old_fingerprint;
+    auto alt_index = [this](const uint32_t& i, const uint32_t& fp) {
+      return GetIndex2(i, fp);
+    };
 
-    for (uint32_t count = 0; count < max_num_kicks; count++) {
-      // If insertion is not possible on first try, there is second index that
-      // can be used for insertion. So kickout must not happen on first try, and
-      // can happen on any of the next insertions for this item
-      bool kickout = count > 0;
-      old_fingerprint = 0;
+    num_items++;
+    const bool inserted = eviction.Insert(*table, alt_index, current_index,
+                                          current_fingerprint, num_kicks);
+    filled_bucket = current_index;
+    if (inserted) return Ok;
 
-      if (table->InsertItemToBucket(current_index, current_fingerprint, kickout,
-                                    old_fingerprint)) {
-        num_items++;
+    stash.Push(current_index, current_fingerprint);
 
-        return Ok;
-      }
+    return Ok;
+  }
 
-      if (kickout) current_fingerprint = old_fingerprint;
+  // Contain method will check if provided item is stored in the CF
+  Status Contain(const item_type& item) { return ContainHash(hasher(item)); }
+
+  template <typename Key>
+  Status Contain(const Key& key) {
+    return ContainHash(hasher(key));
+  }
+
+  Status Contain(const char* data, const size_t& len) {
+    return ContainHash(hasher(data, len));
+  }
 
-      current_index = GetIndex2(current_index, current_fingerprint);
+  // ContainBatch checks count keys (item_type or any other key hash_used can
+  // hash) and writes the result of each into out. Keys are processed in
+  // windows of batch_window: all keys of a window are hashed and both of
+  // their buckets prefetched before any of them is probed, so the cache
+  // misses of a window overlap instead of stalling one after the other.
+  template <typename Key>
+  void ContainBatch(const Key* keys, const size_t& count, Status* out) {
+    HashedItem hashed[batch_window];
+
+    for (size_t start = 0; start < count; start += batch_window) {
+      const size_t window = std::min(batch_window, count - start);
+
+      for (size_t i = 0; i < window; i++) {
+        hashed[i] = GetHashedItem(hasher(keys[start + i]));
+        PrefetchHashedItem(hashed[i]);
+      }
+      for (size_t i = 0; i < window; i++)
+        out[start + i] = ContainHashedItem(hashed[i]);
     }
+  }
 
-    // If we use victime, CF is full
-    victim.used = true;
-    victim.index = current_index;
-    victim.fingerprint = current_fingerprint;
-    num_items++;
+  // ContainHash checks if an item given by its 64-bit hash is stored in the CF
+  Status ContainHash(const uint64_t& hash) {
+    return ContainHashedItem(GetHashedItem(hash));
+  }
 
-    return Ok;
+  // PrefetchHashedItem asks the CPU to load both buckets of a prehashed item
+  void PrefetchHashedItem(const HashedItem& hashed) const {
+    table->Prefetch(hashed.index1);
+    table->Prefetch(hashed.index2);
   }
 
-  // Contain method will check if provided item is stored in the CF
-  Status Contain(const item_type& item) {
-    bool found = false;
-    uint32_t fingerprint = GenerateFingerprint(item);
-    uint32_t index1 = GetIndex1(item);
-    uint32_t index2 = GetIndex2(index1, fingerprint);
-
-    found = (victim.used && victim.fingerprint == fingerprint &&
-             (index1 == victim.index || index2 == victim.index));
-    if (found || table->FindFingerprintInBuckets(index1, index2, fingerprint))
+  // GetHashedItem computes fingerprint and both indexes from a 64-bit hash
+  HashedItem GetHashedItem(const uint64_t& hash) {
+    HashedItem hashed;
+    SplitHash(hash, hashed.index1, hashed.fingerprint);
+    hashed.index2 = GetIndex2(hashed.index1, hashed.fingerprint);
+    return hashed;
+  }
+
+  // ContainHashedItem checks if a prehashed item is stored in the CF
+  Status ContainHashedItem(const HashedItem& hashed) {
+    const uint32_t& fingerprint = hashed.fingerprint;
+    const uint32_t& index1 = hashed.index1;
+    const uint32_t& index2 = hashed.index2;
+
+    if (table->FindFingerprintInBuckets(index1, index2, fingerprint) ||
+        stash.Contain(fingerprint, index1, index2))
       return Ok;
     else
       return NotFound;
   }
 
-  // Delete method will delete an item from the CF. If vitcim was in use, it
-  // will try to add it again.
-  Status Delete(const item_type& item) {
-    uint32_t fingerprint = GenerateFingerprint(item);
-    uint32_t index1 = GetIndex1(item);
-    uint32_t index2 = GetIndex2(index1, fingerprint);
+  // Delete method will delete an item from the CF. If the stash was in use,
+  // it will try to add one stashed item to the table again.
+  Status Delete(const item_type& item) { return DeleteHash(hasher(item)); }
+
+  template <typename Key>
+  Status Delete(const Key& key) {
+    return DeleteHash(hasher(key));
+  }
+
+  Status Delete(const char* data, const size_t& len) {
+    return DeleteHash(hasher(data, len));
+  }
+
+  // DeleteHash deletes an item given by its 64-bit hash from the CF
+  Status DeleteHash(const uint64_t& hash) {
+    return DeleteHashedItem(GetHashedItem(hash));
+  }
+
+  // DeleteHashedItem deletes a prehashed item from the CF
+  Status DeleteHashedItem(const HashedItem& hashed) {
+    const uint32_t& fingerprint = hashed.fingerprint;
+    const uint32_t& index1 = hashed.index1;
+    const uint32_t& index2 = hashed.index2;
 
     if (table->DeleteItemFromBucket(index1, fingerprint)) {
       num_items--;
 
-      if (victim.used) {
-        victim.used = false;
-        AddImpl(victim.index, victim.fingerprint);
-      }
+      if (!stash.Empty()) ReinsertStashed();
 
       return Ok;
     } else if (table->DeleteItemFromBucket(index2, fingerprint)) {
       num_items--;
 
-      if (victim.used) {
-        victim.used = false;
-        AddImpl(victim.index, victim.fingerprint);
-      }
+      if (!stash.Empty()) ReinsertStashed();
 
       return Ok;
-    } else if (victim.used && fingerprint == victim.fingerprint &&
-               (index1 == victim.index || index2 == victim.index)) {
+    } else if (stash.Delete(fingerprint, index1, index2)) {
       num_items--;
-      victim.used = false;
       return Ok;
     }
     return NotFound;
   }
 
+  // InsertSequence adds every k-mer of a sequence to the CF. K-mer hashes are
+  // computed with a rolling ntHash in O(1) per k-mer, k-mers with bases other
+  // than A, C, G or T are skipped. If canonical is true, a k-mer and its
+  // reverse complement are the same item. Returns NotEnoughSpace and stops if
+  // the CF gets full.
+  // Note: single k-mers added this way can be queried with QuerySequence or
+  // with Contain if hash_used is NtHash<canonical>.
+  Status InsertSequence(const std::string_view& seq, const size_t& k,
+                        const bool& canonical = false) {
+    RollingKmerHash rolling(seq.data(), seq.length(), k, canonical);
+
+    while (rolling.Next()) {
+      if (AddHash(rolling.Hash()) != Ok) return NotEnoughSpace;
+    }
+
+    return Ok;
+  }
+
+  // QuerySequence checks every k-mer of a sequence. Element i of the result is
+  // true if the k-mer starting at position i is in the CF.
+  std::vector<bool> QuerySequence(const std::string_view& seq, const size_t& k,
+                                  const bool& canonical = false) {
+    std::vector<bool> found(seq.length() >= k ? seq.length() - k + 1 : 0);
+    RollingKmerHash rolling(seq.data(), seq.length(), k, canonical);
+
+    while (rolling.Next()) {
+      found[rolling.Position()] = ContainHash(rolling.Hash()) == Ok;
+    }
+
+    return found;
+  }
+
+  // Expand doubles the bucket count and max_items of the CF in place, so a
+  // lookup still probes two buckets (unlike adding a CF to a
+  // DynamicCuckooFilter). Every item of bucket i moves to bucket i or
+  // i + BucketCount() depending on its lowest fingerprint bit, which is then
+  // dropped, so each expansion doubles the false positive rate. Both
+  // buckets of an item move together, and stashed items are put back into
+  // the larger table. Returns NotEnoughSpace after max_expansions expansions.
+  Status Expand() {
+    if (expansions == max_expansions) return NotEnoughSpace;
+
+    const uint32_t bucket_count = table->BucketCount();
+    const size_t k_items_per_bucket = table_type::k_items_per_bucket;
+    std::unique_ptr<table_type> expanded =
+        std::make_unique<table_type>(2 * (size_t)bucket_count,
+                                     layout_type::k_alignment);
+    uint32_t old_fingerprint = 0;
+
+    for (uint32_t i = 0; i < bucket_count; i++) {
+      for (uint32_t j = 0; j < k_items_per_bucket; j++) {
+        const uint32_t fingerprint = table->ReadItem(i, j);
+        if (fingerprint == 0) continue;
+        expanded->InsertItemToBucket(i | (fingerprint & 1) * bucket_count,
+                                     fingerprint >> 1, false,
+                                     old_fingerprint);
+      }
+    }
+
+    table = std::move(expanded);
+    expansions++;
+    index_mask = 2 * bucket_count - 1;
+    max_items *= 2;
+
+    std::vector<Victim> stashed(stash.Size());
+    for (size_t i = 0; i < stashed.size(); i++)
+      stash.Get(i, stashed[i].index, stashed[i].fingerprint);
+    while (!stash.Empty()) stash.PopBack();
+    for (Victim& item : stashed) {
+      num_items--;
+      AddImpl(item.index | (item.fingerprint & 1) * bucket_count,
+              item.fingerprint >> 1);
+    }
+
+    return Ok;
+  }
+
+  // Expansions returns how many times the CF was expanded
+  size_t Expansions() const { return expansions; }
+
   // Size returns number of items stored in the CF
   size_t Size() const { return num_items; }
 
+  // Kicks returns number of times an item was moved to its other bucket to
+  // make room for another one
+  size_t Kicks() const { return num_kicks; }
+
   // SizeInBytes returns number of bytes stored in the CF
   size_t SizeInBytes() const { return table->SizeInBytes(); }
 
+  // MaxItems returns how many items the CF can hold
+  size_t MaxItems() const { return max_items; }
+
+  // FingerprintBits returns number of bits kept of every fingerprint
+  size_t FingerprintBits() const { return bits_per_item; }
+
   // LoadFactor returns load factor of the CF
   double LoadFactor() const { return 1.0 * Size() / max_items; }
 
@@ -213,43 +848,90 @@ class CuckooFilter {
   // GetBucketCount returns bucket count
   size_t GetBucketCount() const { return table->BucketCount(); }
 
+  // FilledBucket returns the bucket that the last call of an Add method
+  // filled: the one whose free slot was used or, if the item was stashed,
+  // the bucket stored with it. Adding an item makes no other bucket
+  // non-empty.
+  uint32_t FilledBucket() const { return filled_bucket; }
+
+  // BucketInUse returns true if bucket i holds an item or a stashed item
+  // was stored with bucket i
+  bool BucketInUse(const uint32_t& i) const {
+    for (uint32_t j = 0; j < table_type::k_items_per_bucket; j++)
+      if (table->ReadItem(i, j) != 0) return true;
+
+    uint32_t index, fingerprint;
+    for (size_t k = 0; k < stash.Size(); k++) {
+      stash.Get(k, index, fingerprint);
+      if (index == i) return true;
+    }
+    return false;
+  }
+
   // GetBucketCount returns a bucket at index i from the table
   vector<uint32_t> GetBucketFromTable(const uint32_t& i) {
     return table->GetBucket(i);
   }
 
+  // ReadItemFromBucket returns the item at bucket i and column j of the table
+  // (0 if the slot is empty)
+  uint32_t ReadItemFromBucket(const uint32_t& i, const uint32_t& j) const {
+    return table->ReadItem(i, j);
+  }
+
   // DeleteItemFromBucketDirect deletes an item from a bucket at index i from
-  // the table
+  // the table. If counted is false the number of items is left as it is (see
+  // AddToSize), so threads can delete from different buckets at once.
   Status DeleteItemFromBucketDirect(const uint32_t& i,
-                                    const uint32_t& fingerprint) {
+                                    const uint32_t& fingerprint,
+                                    const bool& counted = true) {
     if (table->DeleteItemFromBucket(i, fingerprint)) {
-      num_items--;
+      if (counted) num_items--;
       return Ok;
     }
     return NotFound;
   }
 
-  // AddToBucket adds an item ta a bucket at index i
-  Status AddToBucket(const uint32_t& i, const uint32_t& item) {
+  // AddToBucket adds an item ta a bucket at index i. If counted is false the
+  // number of items is left as it is (see AddToSize).
+  Status AddToBucket(const uint32_t& i, const uint32_t& item,
+                     const bool& counted = true) {
     bool kickout = false;
     uint32_t old_fingerprint = 0;
     if (table->InsertItemToBucket(i, item, kickout, old_fingerprint)) {
-      num_items++;
+      if (counted) num_items++;
       return Ok;
     }
     return NotEnoughSpace;
   }
 
-  // GetVictim returns an victim
+  // AddToSize adds delta to the number of items, for the items that were
+  // added and deleted with counted set to false
+  void AddToSize(const long& delta) { num_items += delta; }
+
+  // GetVictim returns the last stashed item (used is false if the stash is
+  // empty)
   std::shared_ptr<Victim> GetVictim() {
-    return std::make_shared<Victim>(victim);
+    std::shared_ptr<Victim> victim = std::make_shared<Victim>();
+    victim->used = !stash.Empty();
+    if (victim->used) stash.Back(victim->index, victim->fingerprint);
+    return victim;
   }
 
-  // DeleteVictim will try to match and then delete the victim
+  // HasVictim returns true if any item is stashed
+  bool HasVictim() const { return !stash.Empty(); }
+
+  // IsFull returns true if Add would return NotEnoughSpace: the CF holds
+  // max_items items or its stash is full
+  bool IsFull() const { return num_items == max_items || stash.Full(); }
+
+  // StashSize returns number of stashed items
+  size_t StashSize() const { return stash.Size(); }
+
+  // DeleteVictim will try to match and then delete a stashed item
   Status DeleteVictim(const uint32_t& i, const uint32_t& fingerprint) {
-    if (victim.used && victim.fingerprint == fingerprint && victim.index == i) {
+    if (stash.Delete(fingerprint, i, i)) {
       num_items--;
-      victim.used = false;
       return Ok;
     }
     return NotFound;
@@ -1,7 +1,15 @@
+#pragma once
+
 #include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <iostream>
+#include <limits>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -9,136 +17,585 @@
 
 namespace cuckoofilterbio1 {
 
+// LevelGrowth decides the size and fingerprint width of the CFs that a
+// DynamicCuckooFilter adds, like the growth of a scalable Bloom filter. Each
+// CF holds factor times the items of the previous one, so n items need
+// O(log n) CFs. A factor below 1 is raised to 1: shrinking CFs would end in
+// CFs that hold no items. The first CF keeps fingerprint_bits bits of every
+// fingerprint (0 for the full slot width of table_type) and each following
+// CF fingerprint_step bits more, up to the slot width, so the FPP of the CFs
+// falls geometrically and the FPP of the whole DCF stays bounded. The
+// default adds CFs of the same size and width. When the CFs differ, an item
+// has different buckets and fingerprints in each of them, and a fingerprint
+// that matches in one CF may belong to an item stored in another. The DCF
+// cannot tell which one to remove, so, as with a scalable Bloom filter,
+// items cannot be deleted: Delete and Compact return NotSupported.
+class LevelGrowth {
+ public:
+  double factor;
+  size_t fingerprint_bits;
+  size_t fingerprint_step;
+
+  LevelGrowth(const double& factor = 1, const size_t& fingerprint_bits = 0,
+              const size_t& fingerprint_step = 0)
+      : factor(std::max(factor, 1.0)),
+        fingerprint_bits(fingerprint_bits),
+        fingerprint_step(fingerprint_step) {}
+
+  // Uniform returns true if all CFs get the same size and fingerprint width
+  // in a table with slots of slot_bits bits. Without fingerprint_bits, or if
+  // fingerprint_bits already fills the slot, fingerprint_step is ignored.
+  bool Uniform(const size_t slot_bits) const {
+    return factor == 1 && (fingerprint_step == 0 || fingerprint_bits == 0 ||
+                           fingerprint_bits >= slot_bits);
+  }
+};
+
 // DynamicCuckooFilter is a dynamic data structure that holds onto one or
 // multiple CF instances. Once the current CF instance is filled, new one is
-// added.
+// added. All template arguments are passed on to the CFs.
 template <typename uintx = uint8_t, typename item_type = std::string,
-          class table_type = Table<uintx>, typename hash_used = Hash>
+          class table_type = Table<uintx>, typename hash_used = Hash,
+          class layout_type = FullRangeLayout,
+          class eviction_type = RandomWalkEviction<max_num_kicks>>
 class DynamicCuckooFilter {
-  using TypedCuckooFilter =
-      CuckooFilter<uintx, item_type, table_type, hash_used>;
-
-  // DynamicCuckooFilterNode is a hepler class that is used to create a linked
-  // list of CFs
-  class DynamicCuckooFilterNode {
-   public:
-    std::shared_ptr<TypedCuckooFilter> cf;
-    std::shared_ptr<DynamicCuckooFilterNode> next;
-
-    DynamicCuckooFilterNode(std::shared_ptr<TypedCuckooFilter> cf,
-                            std::shared_ptr<DynamicCuckooFilterNode> next)
-        : cf(cf), next(next) {}
-    virtual ~DynamicCuckooFilterNode() = default;
-  };
+  using TypedCuckooFilter = CuckooFilter<uintx, item_type, table_type,
+                                         hash_used, layout_type, eviction_type>;
 
   // Load factor threshold is used to determine if CF is full or not. Default
   // value is 0.9
   const double load_factor_threshold;
-  // Counter that count number of CFs
-  int counter_CF;
-  // Max items that each CF can hold
+  // Max items that the first CF can hold
   const size_t max_items;
-  // Initial CF pointer
-  std::shared_ptr<DynamicCuckooFilterNode> head_cf_node;
-  // Current CF pointer (first CF that is not full)
-  std::shared_ptr<DynamicCuckooFilterNode> curr_cf_node;
+  // Number of items each CF keeps in its stash
+  const size_t stash_size;
+  // Size and fingerprint width of the CFs that are added
+  const LevelGrowth growth;
+  // All CFs have the same bucket count and fingerprint width, so an item has
+  // the same fingerprint and buckets in each of them
+  const bool uniform;
+  // The DCF was created with keep_summary and the CFs are uniform
+  const bool keep_summary;
+  // CFs in the order they were added. They are stored by value one after
+  // another, so walking the levels follows no links and touches no
+  // reference counts.
+  std::vector<TypedCuckooFilter> cfs;
+  // Position of the current CF (first CF that is not full) in cfs
+  size_t curr_cf;
+  // summary[i] has bit l % k_summary_bits set if bucket i of CF l, or of a
+  // CF whose position has the same remainder, may hold items. Lookups only
+  // probe the CFs whose bit is set for one of the two buckets of an item. It
+  // is kept once there are at least two CFs, if keep_summary is set.
+  std::vector<uint64_t> summary;
+
+  // Compaction is the progress of an incremental compaction (CompactStep)
+  struct Compaction {
+    // positions of the CFs below the load factor threshold when the
+    // compaction started, by ascending size
+    std::vector<size_t> queue;
+    // position in queue of the CF whose buckets are being emptied
+    size_t source = 0;
+    // next bucket of that CF
+    uint32_t bucket = 0;
+    bool active = false;
+  } compaction;
+
+  // CompactionBlock is what one thread of a parallel Compact keeps for each
+  // CF: how many more items it may move into it and how many items it
+  // gained or lost
+  struct CompactionBlock {
+    std::vector<size_t> room;
+    std::vector<long> moved;
+  };
+
+  hash_used hasher;
+
+  // Number of bits of a summary entry
+  static constexpr size_t k_summary_bits = 64;
+
+  // AdvanceCurrentCF moves currCF to the first CF below the load factor
+  // threshold whose stash is not full, creating a new CF at the end if there
+  // is none
+  void AdvanceCurrentCF() {
+    while (cfs[curr_cf].LoadFactor() >= load_factor_threshold ||
+           cfs[curr_cf].IsFull()) {
+      if (++curr_cf == cfs.size()) AddCF();
+    }
+  }
+
+  // AddCF adds a CF at the end, sized and with the fingerprint width growth
+  // gives for its position. No CF holds fewer than max_items items.
+  void AddCF() {
+    const size_t level = cfs.size();
+    const size_t items = std::max<size_t>(
+        max_items, std::ceil(max_items * std::pow(growth.factor, level)));
+    const size_t fingerprint_bits =
+        growth.fingerprint_bits > 0
+            ? growth.fingerprint_bits + level * growth.fingerprint_step
+            : 0;
+
+    cfs.emplace_back(items, 0, stash_size, fingerprint_bits);
+    if (keep_summary && cfs.size() == 2) RebuildSummary();
+  }
+
+  // ItemIn returns the fingerprint and buckets of an item in cf. If the CFs
+  // are uniform, they are the ones first computed for the first CF.
+  HashedItem ItemIn(TypedCuckooFilter& cf, const uint64_t& hash,
+                    const HashedItem& first) {
+    return uniform ? first : cf.GetHashedItem(hash);
+  }
+
+  // DeleteFrom deletes an item from CF level and clears the summary bits of
+  // both of its buckets if they are no longer in use
+  bool DeleteFrom(const size_t& level, const HashedItem& hashed) {
+    TypedCuckooFilter& cf = cfs[level];
+    const bool stashed = cf.HasVictim();
+
+    if (cf.DeleteHashedItem(hashed) != Ok) return false;
+
+    // a stashed item may have moved into the table
+    if (stashed) MarkBucket(level, cf.FilledBucket());
+    UpdateSummary(level, hashed.index1);
+    UpdateSummary(level, hashed.index2);
+    return true;
+  }
+
+  // MarkBucket records that bucket i of CF level may hold items
+  void MarkBucket(const size_t& level, const uint32_t& i) {
+    if (!summary.empty()) summary[i] |= 1ULL << (level % k_summary_bits);
+  }
+
+  // UpdateSummary clears the bit of CF level for bucket i unless bucket i is
+  // in use in a CF that shares the bit
+  void UpdateSummary(const size_t& level, const uint32_t& i) {
+    if (summary.empty()) return;
+
+    for (size_t l = level % k_summary_bits; l < cfs.size(); l += k_summary_bits)
+      if (cfs[l].BucketInUse(i)) return;
+    summary[i] &= ~(1ULL << (level % k_summary_bits));
+  }
+
+  // RebuildSummary computes summary from the buckets of all CFs
+  void RebuildSummary() {
+    summary.assign(cfs.front().GetBucketCount(), 0);
+
+    for (size_t l = 0; l < cfs.size(); l++)
+      for (uint32_t i = 0; i < summary.size(); i++)
+        if (cfs[l].BucketInUse(i)) summary[i] |= 1ULL << (l % k_summary_bits);
+  }
+
+  // PrefetchSummary asks the CPU to load the summary of both buckets of an
+  // item
+  void PrefetchSummary(const HashedItem& hashed) const {
+    if (summary.empty()) return;
+
+    __builtin_prefetch(&summary[hashed.index1]);
+    __builtin_prefetch(&summary[hashed.index2]);
+  }
+
+  // StartCompaction puts the CFs below the load factor threshold into the
+  // queue of a new compaction, by ascending size
+  void StartCompaction() {
+    compaction.queue.clear();
+    for (size_t l = 0; l < cfs.size(); l++)
+      if (cfs[l].LoadFactor() < load_factor_threshold)
+        compaction.queue.push_back(l);
+
+    std::stable_sort(compaction.queue.begin(), compaction.queue.end(),
+                     [this](const size_t& lhs, const size_t& rhs) {
+                       return cfs[lhs].Size() < cfs[rhs].Size();
+                     });
+    compaction.source = 0;
+    compaction.bucket = 0;
+    compaction.active = true;
+  }
+
+  // CompactBucket moves the fingerprints of bucket i of the CF at position
+  // source of the queue into bucket i of the CFs after it, the fullest
+  // first, as long as they are below the load factor threshold and have
+  // room in bucket i. With a block, the room of the CFs and the moved items
+  // are counted in it instead of in the CFs.
+  void CompactBucket(const size_t& source, const uint32_t& i,
+                     CompactionBlock* block = nullptr) {
+    const std::vector<size_t>& queue = compaction.queue;
+    const size_t from = queue[source];
+    TypedCuckooFilter& from_cf = cfs[from];
+
+    uint32_t items[table_type::k_items_per_bucket];
+    size_t count = 0;
+    for (uint32_t j = 0; j < table_type::k_items_per_bucket; j++) {
+      const uint32_t item = from_cf.ReadItemFromBucket(i, j);
+      if (item != 0) items[count++] = item;
+    }
+    if (count == 0) return;
+
+    for (size_t k = queue.size() - 1; count > 0 && k > source; k--) {
+      const size_t to = queue[k];
+      TypedCuckooFilter& to_cf = cfs[to];
+
+      bool moved = false;
+      while (count > 0 &&
+             (block ? block->room[to] > 0
+                    : to_cf.LoadFactor() < load_factor_threshold) &&
+             Ok == to_cf.AddToBucket(i, items[count - 1], !block)) {
+        from_cf.DeleteItemFromBucketDirect(i, items[--count], !block);
+        moved = true;
+        if (block) {
+          block->room[to]--;
+          block->moved[to]++;
+          block->moved[from]--;
+        }
+      }
+      if (moved) MarkBucket(to, i);
+    }
+    UpdateSummary(from, i);
+  }
+
+  // RemoveEmptyCFs removes the empty CFs except the first one and moves the
+  // summary bits of the remaining CFs to their new positions
+  void RemoveEmptyCFs() {
+    std::vector<size_t> position(cfs.size());
+    size_t kept = 0;
+    for (size_t l = 0; l < cfs.size(); l++)
+      position[l] = l == 0 || cfs[l].Size() > 0 ? kept++ : cfs.size();
+    if (kept == cfs.size()) return;
+
+    // with at most k_summary_bits CFs every bit belongs to one CF
+    if (!summary.empty() && kept > 1 && cfs.size() <= k_summary_bits) {
+      for (uint64_t& bits : summary) {
+        uint64_t moved = 0;
+        for (uint64_t b = bits; b != 0; b &= b - 1) {
+          const size_t new_position = position[__builtin_ctzll(b)];
+          if (new_position < cfs.size()) moved |= 1ULL << new_position;
+        }
+        bits = moved;
+      }
+    }
+
+    cfs.erase(std::remove_if(
+                  cfs.begin() + 1, cfs.end(),
+                  [](const TypedCuckooFilter& cf) { return cf.Size() == 0; }),
+              cfs.end());
+
+    if (cfs.size() == 1)
+      summary.clear();
+    else if (!summary.empty() && position.size() > k_summary_bits)
+      RebuildSummary();
+
+    curr_cf = 0;
+    AdvanceCurrentCF();
+  }
+
+  // Candidates returns the summary bits of the CFs that may hold an item.
+  // CF l has to be probed if bit l % k_summary_bits is set. Without a
+  // summary every CF is a candidate.
+  uint64_t Candidates(const HashedItem& hashed) const {
+    if (summary.empty()) return ~0ULL;
+
+    return summary[hashed.index1] | summary[hashed.index2];
+  }
 
  public:
-  // constructor will create inital CF and will set currCF to point at it
+  // constructor will create inital CF and will set currCF to point at it.
+  // stash_size is passed on to every CF. growth decides the size and
+  // fingerprint width of the CFs (see LevelGrowth); by default every CF can
+  // hold max_items items. keep_summary keeps summary, which lets lookups and
+  // deletes skip the CFs that are empty at the buckets of an item. It pays
+  // off when many CFs are sparse, e.g. after many deletes, but costs every
+  // Add a summary update and, with full CFs, lookups a summary read, so it
+  // is off by default. It is only kept if the CFs are uniform.
   DynamicCuckooFilter(const size_t max_items,
-                      double load_factor_threshold = 0.9)
-      : max_items(max_items),
-        head_cf_node(std::make_shared<DynamicCuckooFilterNode>(
-            std::make_shared<TypedCuckooFilter>(max_items), nullptr)),
-        load_factor_threshold(load_factor_threshold),
-        counter_CF(1) {
-    curr_cf_node = head_cf_node;
+                      double load_factor_threshold = 0.9,
+                      const size_t& stash_size = default_stash_size,
+                      const LevelGrowth& growth = LevelGrowth(),
+                      const bool& keep_summary = false)
+      : load_factor_threshold(load_factor_threshold),
+        max_items(max_items),
+        stash_size(stash_size),
+        growth(growth),
+        uniform(growth.Uniform(table_type::k_bits_per_item)),
+        keep_summary(keep_summary && uniform),
+        curr_cf(0) {
+    AddCF();
   }
 
   // destructor
   virtual ~DynamicCuckooFilter() = default;
 
   // Add method will first check if there is room in the currCF for an item to
-  // be added. If load factor threshold if passed, new CF will be created.
-  // Next, item will be added to the currCF. After adding, we need to check if
-  // there is a victim. If there is, add it and free up the victim; this can be
-  // repeated until there is new victim occurring.
+  // be added. If load factor threshold if passed or the stash of currCF is
+  // full, new CF will be created. Next, item will be added to the currCF; an
+  // item that finds no slot stays in the stash of currCF.
   // Note: This method call should always add an item to a DCF
-  Status Add(const item_type& item) {
-    while (curr_cf_node->cf->LoadFactor() >= load_factor_threshold) {
-      if (curr_cf_node->next == nullptr) {
-        curr_cf_node->next = std::make_shared<DynamicCuckooFilterNode>(
-            std::make_shared<TypedCuckooFilter>(max_items), nullptr);
-        ++counter_CF;
+  Status Add(const item_type& item) { return AddHash(hasher(item)); }
+
+  // Add, Contains and Delete also accept other keys that hash_used can hash
+  // without building an item_type (see CuckooFilter::Add)
+  template <typename Key>
+  Status Add(const Key& key) {
+    return AddHash(hasher(key));
+  }
+
+  Status Add(const char* data, const size_t& len) {
+    return AddHash(hasher(data, len));
+  }
+
+  // AddHash adds an item given by its 64-bit hash (as returned by hash_used)
+  Status AddHash(const uint64_t& hash) {
+    AdvanceCurrentCF();
+    TypedCuckooFilter& cf = cfs[curr_cf];
+    const HashedItem hashed = cf.GetHashedItem(hash);
+    // the filled bucket is almost always one of the two
+    PrefetchSummary(hashed);
+
+    const Status status = cf.AddHashedItem(hashed);
+    MarkBucket(curr_cf, cf.FilledBucket());
+
+    return status;
+  }
+
+  // AddBatch adds count keys and writes the status of each into out. Keys are
+  // hashed a window of batch_window keys ahead. The number of items the
+  // current CF takes before it reaches load_factor_threshold is computed
+  // once, and that many items of the window are prefetched and added to it
+  // without checking the load factor for every item (only whether its stash
+  // filled up).
+  template <typename Key>
+  void AddBatch(const Key* keys, const size_t& count, Status* out) {
+    uint64_t hashes[batch_window];
+    HashedItem hashed[batch_window];
+
+    for (size_t start = 0; start < count; start += batch_window) {
+      const size_t window = std::min(batch_window, count - start);
+
+      for (size_t i = 0; i < window; i++) {
+        hashes[i] = hasher(keys[start + i]);
+        hashed[i] = cfs.front().GetHashedItem(hashes[i]);
       }
-      curr_cf_node = curr_cf_node->next;
-    }
 
-    Status add_status = curr_cf_node->cf->Add(item);
+      size_t i = 0;
+      while (i < window) {
+        AdvanceCurrentCF();
+        TypedCuckooFilter& cf = cfs[curr_cf];
 
-    std::shared_ptr<DynamicCuckooFilterNode> tmp_curr_cf_node = curr_cf_node;
+        // the current CF is below the threshold, so it takes at least one
+        const double limit = std::ceil(load_factor_threshold * cf.MaxItems());
+        const size_t room = limit > cf.Size() ? limit - cf.Size() : 1;
+        const size_t chunk = std::min(room, window - i);
 
-    // Check if victim exists
-    std::shared_ptr<Victim> victim = tmp_curr_cf_node->cf->GetVictim();
+        for (size_t j = i; j < i + chunk; j++) {
+          hashed[j] = ItemIn(cf, hashes[j], hashed[j]);
+          cf.PrefetchHashedItem(hashed[j]);
+          PrefetchSummary(hashed[j]);
+        }
+        const size_t end = i + chunk;
+        for (; i < end && !cf.IsFull(); i++) {
+          out[start + i] = cf.AddHashedItem(hashed[i]);
+          MarkBucket(curr_cf, cf.FilledBucket());
+        }
+      }
+    }
+  }
 
-    if (victim->used == false && add_status == Ok) {
+  // Build adds all keys of a range (see CuckooFilter::Build). The keys are
+  // hashed once and split into chunks that fill each CF up to
+  // load_factor_threshold, and every chunk is placed with
+  // CuckooFilter::BuildHashed. Items a CF could not take (its stash is
+  // full) stay at the end of the remaining ones and go into the next chunk.
+  // Hashing and placing use num_threads threads. If the CFs are not uniform,
+  // an item placed for one CF cannot be moved to the next, so the keys are
+  // added one by one instead.
+  template <typename Range>
+  Status Build(const Range& keys, const size_t& num_threads = 1) {
+    if (!uniform) {
+      for (const auto& key : keys) Add(key);
       return Ok;
     }
 
-    while (victim->used == true) {
-      // Remove victim
-      tmp_curr_cf_node->cf->DeleteVictim(victim->index, victim->fingerprint);
+    size_t left = std::distance(std::begin(keys), std::end(keys));
+    std::unique_ptr<HashedItem[]> hashed(new HashedItem[left]);
+    cfs.front().HashKeys(keys, hashed.get(), num_threads);
 
-      if (tmp_curr_cf_node->next == nullptr) {
-        tmp_curr_cf_node->next = std::make_shared<DynamicCuckooFilterNode>(
-            std::make_shared<TypedCuckooFilter>(max_items), nullptr);
-        ++counter_CF;
-      }
+    while (left > 0) {
+      AdvanceCurrentCF();
+      TypedCuckooFilter& cf = cfs[curr_cf];
 
-      tmp_curr_cf_node = tmp_curr_cf_node->next;
-      add_status =
-          tmp_curr_cf_node->cf->AddImpl(victim->index, victim->fingerprint);
+      const double limit = std::ceil(load_factor_threshold * cf.MaxItems());
+      const size_t room = limit > cf.Size() ? limit - cf.Size() : 1;
+      const size_t chunk = std::min(room, left);
 
-      // Check if victim still exists
-      victim = tmp_curr_cf_node->cf->GetVictim();
+      left -= chunk;
+      left += cf.BuildHashed(hashed.get() + left, chunk, num_threads);
     }
+    if (keep_summary && cfs.size() > 1) RebuildSummary();
 
-    // Will be Status.Ok
-    return add_status;
+    return Ok;
   }
 
   // Contains will iterate over all CF in the DCF and check if any CF contains
   // provided item. If true return Ok, NotFound otherwise
-  Status Contains(const item_type& item) {
-    std::shared_ptr<DynamicCuckooFilterNode> tmp_curr_cf_node = head_cf_node;
+  Status Contains(const item_type& item) { return ContainsHash(hasher(item)); }
 
-    while (tmp_curr_cf_node != nullptr) {
-      if (tmp_curr_cf_node->cf->Contain(item) == Ok) {
-        return Ok;
+  template <typename Key>
+  Status Contains(const Key& key) {
+    return ContainsHash(hasher(key));
+  }
+
+  Status Contains(const char* data, const size_t& len) {
+    return ContainsHash(hasher(data, len));
+  }
+
+  // ContainsHash checks if an item given by its 64-bit hash is in the DCF. If
+  // the CFs are uniform, fingerprint and indexes are computed once and reused
+  // for every CF. Only the CFs that summary lists for one of the two buckets
+  // are probed.
+  Status ContainsHash(const uint64_t& hash) {
+    const HashedItem hashed = cfs.front().GetHashedItem(hash);
+    // the first level is usually a candidate, so its buckets are loaded
+    // while the summary is read
+    if (!summary.empty()) cfs.front().PrefetchHashedItem(hashed);
+    const uint64_t candidates = Candidates(hashed);
+
+    // when most levels are candidates, probing all of them in order is
+    // cheaper than a branch per level
+    if (2 * __builtin_popcountll(candidates) >=
+        std::min(cfs.size(), k_summary_bits)) {
+      for (TypedCuckooFilter& cf : cfs) {
+        if (cf.ContainHashedItem(ItemIn(cf, hash, hashed)) == Ok) {
+          return Ok;
+        }
       }
+      return NotFound;
+    }
 
-      tmp_curr_cf_node = tmp_curr_cf_node->next;
+    for (uint64_t bits = candidates; bits != 0; bits &= bits - 1) {
+      for (size_t l = __builtin_ctzll(bits); l < cfs.size();
+           l += k_summary_bits) {
+        if (cfs[l].ContainHashedItem(hashed) == Ok) {
+          return Ok;
+        }
+      }
     }
 
     return NotFound;
   }
 
+  // ContainsBatch checks count keys and writes the result of each into out.
+  // Keys are hashed once per window of batch_window keys; then, level by
+  // level, the buckets of every key not found yet are prefetched before any
+  // of them is probed, so the misses of a window overlap on every level. Keys
+  // skip the levels that summary does not list for them.
+  template <typename Key>
+  void ContainsBatch(const Key* keys, const size_t& count, Status* out) {
+    uint64_t hashes[batch_window];
+    HashedItem hashed[batch_window];
+    uint64_t candidates[batch_window];
+    // positions in the window of keys that are not found yet
+    size_t pending[batch_window];
+
+    for (size_t start = 0; start < count; start += batch_window) {
+      const size_t window = std::min(batch_window, count - start);
+      size_t pending_count = window;
+
+      for (size_t i = 0; i < window; i++) {
+        hashes[i] = hasher(keys[start + i]);
+        hashed[i] = cfs.front().GetHashedItem(hashes[i]);
+        candidates[i] = Candidates(hashed[i]);
+        out[start + i] = NotFound;
+        pending[i] = i;
+      }
+
+      for (size_t level = 0; level < cfs.size() && pending_count > 0;
+           level++) {
+        TypedCuckooFilter& cf = cfs[level];
+        const uint64_t bit = 1ULL << (level % k_summary_bits);
+
+        for (size_t p = 0; p < pending_count; p++) {
+          const size_t q = pending[p];
+          hashed[q] = ItemIn(cf, hashes[q], hashed[q]);
+          if (candidates[q] & bit) cf.PrefetchHashedItem(hashed[q]);
+        }
+
+        size_t still_pending = 0;
+        for (size_t p = 0; p < pending_count; p++) {
+          if ((candidates[pending[p]] & bit) &&
+              cf.ContainHashedItem(hashed[pending[p]]) == Ok)
+            out[start + pending[p]] = Ok;
+          else
+            pending[still_pending++] = pending[p];
+        }
+        pending_count = still_pending;
+      }
+    }
+  }
+
   // Delete will iterate over all CF in the DCF and delete an item if any CF
   // contains it. If item deleted successfuly return Ok, NotFound otherwise
-  Status Delete(const item_type& item) {
-    std::shared_ptr<DynamicCuckooFilterNode> tmp_curr_cf_node = head_cf_node;
+  Status Delete(const item_type& item) { return DeleteHash(hasher(item)); }
 
-    while (tmp_curr_cf_node != nullptr) {
-      if (tmp_curr_cf_node->cf->Delete(item) == Ok) {
-        return Ok;
-      }
+  template <typename Key>
+  Status Delete(const Key& key) {
+    return DeleteHash(hasher(key));
+  }
+
+  Status Delete(const char* data, const size_t& len) {
+    return DeleteHash(hasher(data, len));
+  }
 
-      tmp_curr_cf_node = tmp_curr_cf_node->next;
+  // DeleteHash deletes an item given by its 64-bit hash from the DCF. Only
+  // the CFs that summary lists are probed, and the summary bits of both
+  // buckets are cleared if they are no longer in use. Returns NotSupported
+  // if the CFs are not uniform (see LevelGrowth).
+  Status DeleteHash(const uint64_t& hash) {
+    if (!uniform) return NotSupported;
+
+    const HashedItem hashed = cfs.front().GetHashedItem(hash);
+
+    if (summary.empty()) {
+      for (size_t l = 0; l < cfs.size(); l++)
+        if (DeleteFrom(l, hashed)) return Ok;
+      return NotFound;
+    }
+
+    for (uint64_t bits = Candidates(hashed); bits != 0; bits &= bits - 1) {
+      for (size_t l = __builtin_ctzll(bits); l < cfs.size();
+           l += k_summary_bits) {
+        if (DeleteFrom(l, hashed)) return Ok;
+      }
     }
 
     return NotFound;
   }
 
+  // InsertSequence adds every k-mer of a sequence to the DCF using a rolling
+  // ntHash (O(1) per k-mer). K-mers with bases other than A, C, G or T are
+  // skipped. If canonical is true, a k-mer and its reverse complement are the
+  // same item. See CuckooFilter::InsertSequence.
+  Status InsertSequence(const std::string_view& seq, const size_t& k,
+                        const bool& canonical = false) {
+    RollingKmerHash rolling(seq.data(), seq.length(), k, canonical);
+
+    while (rolling.Next()) {
+      AddHash(rolling.Hash());
+    }
+
+    return Ok;
+  }
+
+  // QuerySequence checks every k-mer of a sequence. Element i of the result is
+  // true if the k-mer starting at position i is in the DCF.
+  std::vector<bool> QuerySequence(const std::string_view& seq, const size_t& k,
+                                  const bool& canonical = false) {
+    std::vector<bool> found(seq.length() >= k ? seq.length() - k + 1 : 0);
+    RollingKmerHash rolling(seq.data(), seq.length(), k, canonical);
+
+    while (rolling.Next()) {
+      found[rolling.Position()] = ContainsHash(rolling.Hash()) == Ok;
+    }
+
+    return found;
+  }
+
   // Compact will "compress" the DQF so each not filled CF is filled as much as
   // possible.
   // Algorithm:
@@ -156,102 +613,123 @@ class DynamicCuckooFilter {
   //        remove curCF from DCF;
   //        break;
   // return true.
-  Status Compact() {
-    std::shared_ptr<DynamicCuckooFilterNode> tmp_curr_cf_node = head_cf_node;
-    std::vector<std::shared_ptr<TypedCuckooFilter>> dynamic_cuckoo_queue;
-
-    // create sorted CFQ
-    while (tmp_curr_cf_node != nullptr) {
-      if (tmp_curr_cf_node->cf->LoadFactor() < load_factor_threshold)
-        dynamic_cuckoo_queue.push_back(tmp_curr_cf_node->cf);
-
-      tmp_curr_cf_node = tmp_curr_cf_node->next;
+  // If a compaction started by CompactStep is in progress, Compact finishes
+  // it. With num_threads above 1, the buckets are split into blocks and that
+  // many threads compact a block each (see ParallelCompact). Returns
+  // NotSupported if the CFs are not uniform (see LevelGrowth).
+  Status Compact(const size_t& num_threads = 1) {
+    if (!uniform) return NotSupported;
+    if (num_threads > 1) return ParallelCompact(num_threads);
+
+    while (!CompactStep(std::numeric_limits<size_t>::max())) {
     }
+    return Ok;
+  }
 
-    std::sort(dynamic_cuckoo_queue.begin(), dynamic_cuckoo_queue.end(),
-              [](std::shared_ptr<TypedCuckooFilter> lhs,
-                 std::shared_ptr<TypedCuckooFilter> rhs) {
-                return lhs->Size() < rhs->Size();
-              });
-
-    // for each CF in CFQ
-    for (uint32_t i = 0; i < dynamic_cuckoo_queue.size(); i++) {
-      std::shared_ptr<TypedCuckooFilter> tmp_cf = dynamic_cuckoo_queue[i];
-
-      // for each Bucket in CF
-      size_t bucket_count = tmp_cf->GetBucketCount();
-      for (uint32_t j = 0; j < bucket_count; j++) {
-        std::vector<uint32_t> bucket_at_j_from_tmp_cf =
-            tmp_cf->GetBucketFromTable(j);
-
-        // for each CF after i in reversed CFQ
-        for (uint32_t k = dynamic_cuckoo_queue.size() - 1;
-             bucket_at_j_from_tmp_cf.size() > 0 && k > i; k--) {
-          // move fingerprint from one bucket to another until:
-          // - there are no more items to be moved
-          // - CF in which we are moving fingerpints is filled
-          // - no more space in a bucket
-          while (bucket_at_j_from_tmp_cf.size() > 0 &&
-                 dynamic_cuckoo_queue[k]->LoadFactor() <
-                     load_factor_threshold &&
-                 Ok == dynamic_cuckoo_queue[k]->AddToBucket(
-                           i, bucket_at_j_from_tmp_cf[0])) {
-            // remove moved fingerprint
-            tmp_cf->DeleteItemFromBucketDirect(j, bucket_at_j_from_tmp_cf[0]);
-
-            bucket_at_j_from_tmp_cf.erase(bucket_at_j_from_tmp_cf.begin());
-          }
-        }
+  // ParallelCompact compacts like Compact, but the buckets of the CFs are
+  // split into 2 * num_threads blocks. Moving a fingerprint only touches its
+  // bucket in two CFs and the summary of that bucket, so the blocks are
+  // independent. As in CuckooFilter::BuildHashed, the even blocks are
+  // compacted at the same time and then the odd ones, so no two neighbouring
+  // blocks are written at once. Each block may fill a CF up to its share of
+  // the room below the load factor threshold, and the item counts of the CFs
+  // are updated once all blocks are done.
+  Status ParallelCompact(const size_t& num_threads) {
+    if (!uniform) return NotSupported;
+    if (!compaction.active) StartCompaction();
+
+    const std::vector<size_t>& queue = compaction.queue;
+    size_t blocks = 2 * num_threads;
+    // a block must be wider than a table access that straddles buckets
+    if (cfs.front().SizeInBytes() / blocks < 64) blocks = 1;
+
+    std::vector<CompactionBlock> block(blocks);
+    for (size_t b = 0; b < blocks; b++) {
+      block[b].room.assign(cfs.size(), 0);
+      block[b].moved.assign(cfs.size(), 0);
+      for (size_t l = 0; l < cfs.size(); l++) {
+        const double limit =
+            std::ceil(load_factor_threshold * cfs[l].MaxItems());
+        const size_t room = limit > cfs[l].Size() ? limit - cfs[l].Size() : 0;
+        block[b].room[l] = room * (b + 1) / blocks - room * b / blocks;
+      }
+    }
 
-        // if the CF is empty, remove it from DCF
-        if (tmp_cf->Size() == 0) {
-          tmp_curr_cf_node = head_cf_node;
+    auto compact = [&](const size_t& b) {
+      for (size_t source = compaction.source; source + 1 < queue.size();
+           source++) {
+        const size_t bucket_count = cfs[queue[source]].GetBucketCount();
+        for (uint32_t i = bucket_count * b / blocks;
+             i < bucket_count * (b + 1) / blocks; i++)
+          CompactBucket(source, i, &block[b]);
+      }
+    };
+    for (size_t parity = 0; parity < 2; parity++) {
+      RunThreads((blocks + 1 - parity) / 2, [&](const size_t& t) {
+        if (2 * t + parity < blocks) compact(2 * t + parity);
+      });
+    }
 
-          while (tmp_curr_cf_node->next != nullptr) {
-            if (tmp_curr_cf_node->next->cf->Size() == 0) {
-              tmp_curr_cf_node->next = tmp_curr_cf_node->next->next;
-              break;
-            }
+    for (size_t b = 0; b < blocks; b++)
+      for (size_t l = 0; l < cfs.size(); l++)
+        cfs[l].AddToSize(block[b].moved[l]);
 
-            tmp_curr_cf_node = tmp_curr_cf_node->next;
-          }
+    RemoveEmptyCFs();
+    compaction = Compaction();
+    return Ok;
+  }
 
-          break;
-        }
+  // CompactStep does a part of Compact: it empties at most budget buckets
+  // (at least one) of the CFs in the queue and returns true once the
+  // compaction is finished, or false if there is more to do. The first call
+  // builds the queue and the last one removes the empty CFs. The DCF can be
+  // used as usual between calls: moved fingerprints keep their buckets and
+  // the summary is updated with every move. CFs added in between are not
+  // compacted until the next compaction. If the CFs are not uniform, items
+  // cannot be deleted or moved (see LevelGrowth) and it returns true at once.
+  bool CompactStep(const size_t& budget) {
+    if (!uniform) return true;
+    if (!compaction.active) StartCompaction();
+
+    const std::vector<size_t>& queue = compaction.queue;
+    size_t work = 0;
+    // the last CF of the queue has no CF to move its items to
+    while (compaction.source + 1 < queue.size()) {
+      const TypedCuckooFilter& source = cfs[queue[compaction.source]];
+      if (compaction.bucket == source.GetBucketCount() || source.Size() == 0) {
+        compaction.source++;
+        compaction.bucket = 0;
+        continue;
       }
-    }
+      if (work++ == std::max<size_t>(budget, 1)) return false;
 
-    // Restart curr_cf_node to first not filled CF in DCF
-    curr_cf_node = head_cf_node;
-    while (curr_cf_node->cf->LoadFactor() >= load_factor_threshold) {
-      curr_cf_node = curr_cf_node->next;
+      CompactBucket(compaction.source, compaction.bucket++);
     }
 
-    return Ok;
+    RemoveEmptyCFs();
+    compaction = Compaction();
+    return true;
   }
+
   vector<size_t> const SizeOfEachCF() {
     vector<size_t> sizes;
-    for (std::shared_ptr<DynamicCuckooFilterNode> n = head_cf_node;
-         n != nullptr; n = n->next) {
-      sizes.push_back(n->cf->Size());
-    }
+    for (const TypedCuckooFilter& cf : cfs) sizes.push_back(cf.Size());
     return sizes;
   }
   size_t TotalSize() {
     size_t sizes = 0;
-    for (std::shared_ptr<DynamicCuckooFilterNode> n = head_cf_node;
-         n != nullptr; n = n->next) {
-      sizes += n->cf->Size();
-    }
+    for (const TypedCuckooFilter& cf : cfs) sizes += cf.Size();
     return sizes;
   }
   size_t TotalSizeInBytes() const {
     size_t sizes = 0;
-    for (std::shared_ptr<DynamicCuckooFilterNode> n = head_cf_node;
-         n != nullptr; n = n->next) {
-      sizes += n->cf->SizeInBytes();
-    }
-    return sizes;
+    for (const TypedCuckooFilter& cf : cfs) sizes += cf.SizeInBytes();
+    return sizes + summary.size() * sizeof(uint64_t);
+  }
+  size_t TotalKicks() const {
+    size_t kicks = 0;
+    for (const TypedCuckooFilter& cf : cfs) kicks += cf.Kicks();
+    return kicks;
   }
 
   string Info() {
@@ -259,12 +737,61 @@ class DynamicCuckooFilter {
 
     ss << "DynamicCuckooFilter Status:" << std::endl;
     int br = 1;
-    for (std::shared_ptr<DynamicCuckooFilterNode> n = head_cf_node;
-         n != nullptr; n = n->next) {
-      ss << "CuckooFilter " << br++ << "\n" << n->cf->Info();
+    for (TypedCuckooFilter& cf : cfs) {
+      ss << "CuckooFilter " << br++ << "\n" << cf.Info();
     }
 
     return ss.str();
   }
 };
+
+// BackgroundCompaction compacts a DCF on its own thread, calling CompactStep
+// with budget buckets at a time until the compaction is finished. The DCF is
+// not thread-safe: mutex is held during every step, and the other threads
+// must hold it whenever they use the DCF. Between steps the thread yields,
+// so they do not wait longer than one step.
+template <class filter_type>
+class BackgroundCompaction {
+  filter_type& filter;
+  std::mutex& mutex;
+  const size_t budget;
+  std::atomic<bool> stop;
+  std::atomic<bool> done;
+  std::thread thread;
+
+  // Run does steps until the compaction is finished or Stop is called
+  void Run() {
+    while (!stop) {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (filter.CompactStep(budget)) break;
+      }
+      std::this_thread::yield();
+    }
+    done = true;
+  }
+
+ public:
+  BackgroundCompaction(filter_type& filter, std::mutex& mutex,
+                       const size_t& budget = 1024)
+      : filter(filter),
+        mutex(mutex),
+        budget(budget),
+        stop(false),
+        done(false),
+        thread(&BackgroundCompaction::Run, this) {}
+
+  // destructor stops the compaction
+  ~BackgroundCompaction() { Stop(); }
+
+  // Stop stops the compaction after the current step. The DCF stays usable
+  // and a later CompactStep or Compact continues the compaction.
+  void Stop() {
+    stop = true;
+    if (thread.joinable()) thread.join();
+  }
+
+  // Done returns true once the thread has stopped
+  bool Done() const { return done; }
+};
 }  // namespace cuckoofilterbio1
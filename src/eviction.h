@@ -0,0 +1,148 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <vector>
+
+namespace cuckoofilterbio1 {
+// Eviction policies decide how an item is placed when both of its buckets
+// are full. A policy has one method:
+//   bool Insert(table_type &table, const alt_index_type &alt_index,
+//               uint32_t &index, uint32_t &fingerprint, size_t &kicks)
+// It tries bucket index and alt_index(index, fingerprint) and moves other
+// items out of the way if needed. It returns true once fingerprint is
+// stored, with index set to the bucket whose free slot was used (the only
+// bucket that can have been empty before). Otherwise it returns false with
+// index and fingerprint set to an item that has no slot left (the victim).
+// kicks is increased by the number of items moved to another bucket.
+
+// RandomWalkEviction swaps the item with a random slot of a full bucket and
+// moves the evicted item to its other bucket, up to max_kicks times
+// (default)
+template <size_t max_kicks = 500>
+class RandomWalkEviction {
+ public:
+  template <class table_type, class alt_index_type>
+  bool Insert(table_type &table, const alt_index_type &alt_index,
+              uint32_t &index, uint32_t &fingerprint, size_t &kicks) {
+    uint32_t old_fingerprint;
+
+    for (size_t count = 0; count < max_kicks; count++) {
+      // If insertion is not possible on first try, there is second index that
+      // can be used for insertion. So kickout must not happen on first try,
+      // and can happen on any of the next insertions for this item
+      bool kickout = count > 0;
+      old_fingerprint = 0;
+
+      if (table.InsertItemToBucket(index, fingerprint, kickout,
+                                   old_fingerprint))
+        return true;
+
+      if (kickout) {
+        fingerprint = old_fingerprint;
+        kicks++;
+      }
+
+      index = alt_index(index, fingerprint);
+    }
+
+    return false;
+  }
+};
+
+// BreadthFirstEviction searches breadth-first for the shortest chain of
+// items that ends in a bucket with a free slot, visiting at most max_nodes
+// buckets, and moves the items only once such a chain is found, starting
+// from its free end. Near full load this keeps chains short, and when no
+// chain is found nothing has moved and the new item itself is the victim.
+// Buckets are prefetched as they are queued, so the misses of one level of
+// the search overlap.
+template <size_t max_nodes = 500>
+class BreadthFirstEviction {
+  // Node is a bucket on a path from one of the two first buckets. fingerprint
+  // is the item of the parent bucket that moves into this bucket.
+  struct Node {
+    uint32_t index;
+    uint32_t fingerprint;
+    int32_t parent;
+  };
+
+  std::vector<Node> queue;
+
+  // OnPath returns true if bucket index is node or one of its ancestors
+  bool OnPath(int32_t node, const uint32_t &index) const {
+    for (; node >= 0; node = queue[node].parent)
+      if (queue[node].index == index) return true;
+    return false;
+  }
+
+  // MovePath moves the items along the path ending in node, from the end
+  // that has a free slot back to the first bucket, and stores fingerprint
+  template <class table_type>
+  void MovePath(table_type &table, int32_t node, const uint32_t &fingerprint,
+                size_t &kicks) {
+    uint32_t old_fingerprint = 0;
+
+    for (; queue[node].parent >= 0; node = queue[node].parent) {
+      const Node &parent = queue[queue[node].parent];
+      table.InsertItemToBucket(queue[node].index, queue[node].fingerprint,
+                               false, old_fingerprint);
+      table.DeleteItemFromBucket(parent.index, queue[node].fingerprint);
+      kicks++;
+    }
+    table.InsertItemToBucket(queue[node].index, fingerprint, false,
+                             old_fingerprint);
+  }
+
+ public:
+  BreadthFirstEviction() { queue.reserve(max_nodes); }
+
+  template <class table_type, class alt_index_type>
+  bool Insert(table_type &table, const alt_index_type &alt_index,
+              uint32_t &index, uint32_t &fingerprint, size_t &kicks) {
+    const size_t k_items_per_bucket = table_type::k_items_per_bucket;
+    uint32_t old_fingerprint = 0;
+
+    const uint32_t index2 = alt_index(index, fingerprint);
+    if (table.InsertItemToBucket(index, fingerprint, false, old_fingerprint))
+      return true;
+    if (table.InsertItemToBucket(index2, fingerprint, false,
+                                 old_fingerprint)) {
+      index = index2;
+      return true;
+    }
+
+    queue.clear();
+    queue.push_back({index, fingerprint, -1});
+    if (index2 != index) queue.push_back({index2, fingerprint, -1});
+
+    for (size_t head = 0; head < queue.size(); head++) {
+      const uint32_t bucket = queue[head].index;
+      uint32_t items[k_items_per_bucket];
+      bool free_slot = false;
+      for (uint32_t j = 0; j < k_items_per_bucket; j++) {
+        items[j] = table.ReadItem(bucket, j);
+        free_slot |= items[j] == 0;
+      }
+
+      if (free_slot) {
+        MovePath(table, head, fingerprint, kicks);
+        index = bucket;
+        return true;
+      }
+
+      for (uint32_t j = 0; j < k_items_per_bucket && queue.size() < max_nodes;
+           j++) {
+        const uint32_t alt = alt_index(bucket, items[j]);
+        if (OnPath(head, alt)) continue;
+
+        table.Prefetch(alt);
+        queue.push_back({alt, items[j], (int32_t)head});
+      }
+    }
+
+    return false;
+  }
+};
+}  // namespace cuckoofilterbio1
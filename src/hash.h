@@ -1,13 +1,107 @@
+#pragma once
+
 #include <stdint.h>
 
+#include <cstring>
 #include <string>
-
-#define get16bits(d) (*((const uint16_t *)(d)))
+#include <string_view>
+#include <type_traits>
 
 namespace cuckoofilterbio1 {
-// Class used for calculating a hash of a string
-class Hash {
-  static uint32_t SuperFastHash(const void *buf, size_t len) {
+// Hash policies are used as the hash_used template parameter of CuckooFilter
+// and DynamicCuckooFilter. A policy is default constructible and its
+// operator() returns a 64-bit hash of an item. The low bits of the hash are
+// used for the bucket index and the high bits for the fingerprint, so both
+// halves must be well mixed.
+//
+// HashFunction is the common base of the byte-oriented policies below; each
+// of them only implements HashBytes. Besides std::string it hashes
+// std::string_view, (const char*, size_t) and fixed-width integers without
+// allocating; a std::string, a view of it and its (data, length) pair all get
+// the same hash.
+template <class Impl>
+class HashFunction {
+ public:
+  uint64_t operator()(const std::string_view &s) const {
+    return Impl::HashBytes(s.data(), s.length());
+  }
+
+  uint64_t operator()(const char *data, const size_t &len) const {
+    return Impl::HashBytes(data, len);
+  }
+
+  // Integers are hashed by their bytes in memory
+  template <typename T,
+            typename std::enable_if<std::is_integral<T>::value, int>::type = 0>
+  uint64_t operator()(const T &value) const {
+    return Impl::HashBytes(&value, sizeof(T));
+  }
+};
+
+namespace hashdetail {
+// Unaligned little-endian reads; memcpy compiles to a single load
+inline uint64_t Read64(const uint8_t *p) {
+  uint64_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+inline uint32_t Read32(const uint8_t *p) {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+inline uint64_t Rotl64(uint64_t x, int r) {
+  return (x << r) | (x >> (64 - r));
+}
+
+// Fmix64 is the MurmurHash3 64-bit finalizer
+inline uint64_t Fmix64(uint64_t k) {
+  k ^= k >> 33;
+  k *= 0xff51afd7ed558ccdULL;
+  k ^= k >> 33;
+  k *= 0xc4ceb9fe1a85ec53ULL;
+  k ^= k >> 33;
+  return k;
+}
+
+// Mum multiplies a and b to a 128-bit product and stores the low half in a
+// and the high half in b
+inline void Mum(uint64_t &a, uint64_t &b) {
+#ifdef __SIZEOF_INT128__
+  __uint128_t r = (__uint128_t)a * b;
+  a = (uint64_t)r;
+  b = (uint64_t)(r >> 64);
+#else
+  uint64_t ha = a >> 32, hb = b >> 32, la = (uint32_t)a, lb = (uint32_t)b;
+  uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+  uint64_t t = rl + (rm0 << 32), c = t < rl;
+  uint64_t lo = t + (rm1 << 32);
+  c += lo < t;
+  a = lo;
+  b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
+
+// Mix folds the 128-bit product of a and b into 64 bits
+inline uint64_t Mix(uint64_t a, uint64_t b) {
+  Mum(a, b);
+  return a ^ b;
+}
+}  // namespace hashdetail
+
+// SuperFastHash (Paul Hsieh) is the original 32-bit hash of this project. The
+// result is widened to 64 bits with the MurmurHash3 finalizer; it still has
+// only 32 bits of entropy.
+class SuperFastHash : public HashFunction<SuperFastHash> {
+  static uint16_t Get16Bits(const char *d) {
+    uint16_t v;
+    memcpy(&v, d, sizeof(v));
+    return v;
+  }
+
+  static uint32_t SuperFastHash32(const void *buf, size_t len) {
     const char *data = (const char *)buf;
     uint32_t hash = len, tmp;
     int rem;
@@ -19,8 +113,8 @@ class Hash {
 
     /* Main loop */
     for (; len > 0; len--) {
-      hash += get16bits(data);
-      tmp = (get16bits(data + 2) << 11) ^ hash;
+      hash += Get16Bits(data);
+      tmp = (Get16Bits(data + 2) << 11) ^ hash;
       hash = (hash << 16) ^ tmp;
       data += 2 * sizeof(uint16_t);
       hash += hash >> 11;
@@ -29,13 +123,13 @@ class Hash {
     /* Handle end cases */
     switch (rem) {
       case 3:
-        hash += get16bits(data);
+        hash += Get16Bits(data);
         hash ^= hash << 16;
         hash ^= data[sizeof(uint16_t)] << 18;
         hash += hash >> 11;
         break;
       case 2:
-        hash += get16bits(data);
+        hash += Get16Bits(data);
         hash ^= hash << 11;
         hash += hash >> 17;
         break;
@@ -57,8 +151,139 @@ class Hash {
   }
 
  public:
-  uint32_t operator()(const std::string &s) {
-    return SuperFastHash(s.data(), s.length());
+  static uint64_t HashBytes(const void *buf, size_t len) {
+    uint64_t hash = SuperFastHash32(buf, len);
+    return hashdetail::Fmix64((hash << 32 | hash) ^ len);
+  }
+};
+
+// MurmurHash3 is the x64_128 variant of Austin Appleby's MurmurHash3; the
+// first 64 bits of the 128-bit result are returned
+class MurmurHash3 : public HashFunction<MurmurHash3> {
+ public:
+  static uint64_t HashBytes(const void *buf, size_t len) {
+    using namespace hashdetail;
+    const uint8_t *data = (const uint8_t *)buf;
+    const size_t nblocks = len / 16;
+    const uint64_t c1 = 0x87c37b91114253d5ULL;
+    const uint64_t c2 = 0x4cf5ad432745937fULL;
+    uint64_t h1 = 0, h2 = 0;
+
+    for (size_t i = 0; i < nblocks; i++) {
+      uint64_t k1 = Read64(data + i * 16);
+      uint64_t k2 = Read64(data + i * 16 + 8);
+
+      k1 *= c1;
+      k1 = Rotl64(k1, 31);
+      k1 *= c2;
+      h1 ^= k1;
+      h1 = Rotl64(h1, 27);
+      h1 += h2;
+      h1 = h1 * 5 + 0x52dce729;
+
+      k2 *= c2;
+      k2 = Rotl64(k2, 33);
+      k2 *= c1;
+      h2 ^= k2;
+      h2 = Rotl64(h2, 31);
+      h2 += h1;
+      h2 = h2 * 5 + 0x38495ab5;
+    }
+
+    const uint8_t *tail = data + nblocks * 16;
+    const size_t rem = len & 15;
+    uint64_t k1 = 0, k2 = 0;
+
+    for (size_t i = rem; i > 8; i--)
+      k2 ^= ((uint64_t)tail[i - 1]) << ((i - 9) * 8);
+    if (rem > 8) {
+      k2 *= c2;
+      k2 = Rotl64(k2, 33);
+      k2 *= c1;
+      h2 ^= k2;
+    }
+
+    for (size_t i = rem < 8 ? rem : 8; i > 0; i--)
+      k1 ^= ((uint64_t)tail[i - 1]) << ((i - 1) * 8);
+    if (rem > 0) {
+      k1 *= c1;
+      k1 = Rotl64(k1, 31);
+      k1 *= c2;
+      h1 ^= k1;
+    }
+
+    h1 ^= len;
+    h2 ^= len;
+    h1 += h2;
+    h2 += h1;
+    h1 = Fmix64(h1);
+    h2 = Fmix64(h2);
+    h1 += h2;
+
+    return h1;
+  }
+};
+
+// WyHash is a wyhash-style hash: 16 or 48 bytes are consumed per step and
+// folded with 64x64->128 bit multiplications. It is the default policy.
+class WyHash : public HashFunction<WyHash> {
+  static constexpr uint64_t k_secret[4] = {
+      0xa0761d6478bd642fULL, 0xe7037ed1a0b428dbULL, 0x8ebc6af09c88c6e3ULL,
+      0x589965cc75374cc3ULL};
+
+  // Read3 reads 1 to 3 bytes
+  static uint64_t Read3(const uint8_t *p, size_t len) {
+    return (((uint64_t)p[0]) << 16) | (((uint64_t)p[len >> 1]) << 8) |
+           p[len - 1];
+  }
+
+ public:
+  static uint64_t HashBytes(const void *buf, size_t len) {
+    using namespace hashdetail;
+    const uint8_t *p = (const uint8_t *)buf;
+    uint64_t seed = Mix(k_secret[0], k_secret[1]);
+    uint64_t a, b;
+
+    if (len <= 16) {
+      if (len >= 4) {
+        a = ((uint64_t)Read32(p) << 32) | Read32(p + ((len >> 3) << 2));
+        b = ((uint64_t)Read32(p + len - 4) << 32) |
+            Read32(p + len - 4 - ((len >> 3) << 2));
+      } else if (len > 0) {
+        a = Read3(p, len);
+        b = 0;
+      } else {
+        a = b = 0;
+      }
+    } else {
+      size_t i = len;
+      if (i > 48) {
+        uint64_t see1 = seed, see2 = seed;
+        do {
+          seed = Mix(Read64(p) ^ k_secret[1], Read64(p + 8) ^ seed);
+          see1 = Mix(Read64(p + 16) ^ k_secret[2], Read64(p + 24) ^ see1);
+          see2 = Mix(Read64(p + 32) ^ k_secret[3], Read64(p + 40) ^ see2);
+          p += 48;
+          i -= 48;
+        } while (i > 48);
+        seed ^= see1 ^ see2;
+      }
+      while (i > 16) {
+        seed = Mix(Read64(p) ^ k_secret[1], Read64(p + 8) ^ seed);
+        i -= 16;
+        p += 16;
+      }
+      a = Read64(p + i - 16);
+      b = Read64(p + i - 8);
+    }
+
+    a ^= k_secret[1];
+    b ^= seed;
+    Mum(a, b);
+    return Mix(a ^ k_secret[0] ^ len, b ^ k_secret[1]);
   }
 };
-}  // namespace cuckoofilter
\ No newline at end of file
+
+// Hash is the default hash policy
+using Hash = WyHash;
+}  // namespace cuckoofilterbio1
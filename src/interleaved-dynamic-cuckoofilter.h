@@ -0,0 +1,471 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "cuckoofilter.h"
+
+namespace cuckoofilterbio1 {
+
+// InterleavedDynamicCuckooFilter is a DynamicCuckooFilter that stores all of
+// its CFs (levels) in one table. Every level has the same bucket count, so
+// bucket j of all levels is kept together in row j of the table, one level
+// after another. A lookup compares the whole rows of both buckets of an item
+// with SIMD, so a miss reads two contiguous regions instead of two buckets
+// on every level. Rows have room for `stride` levels; once all of them are
+// used, the table is re-strided to twice as many levels per row in one
+// pass. Levels are filled one after another, each with its own stash, like
+// the CFs of a DynamicCuckooFilter, and fingerprint and buckets of an item
+// are the ones a CuckooFilter with the same max_items would use.
+// Buckets are arrays of items_per_bucket uintx fingerprints, as in Table.
+template <typename uintx = uint8_t, typename item_type = std::string,
+          size_t items_per_bucket = 4, typename hash_used = Hash,
+          class layout_type = FullRangeLayout,
+          class eviction_type = RandomWalkEviction<max_num_kicks>,
+          class allocator_type = AlignedAllocator<>>
+class InterleavedDynamicCuckooFilter {
+  static_assert(items_per_bucket == 2 || items_per_bucket == 4 ||
+                    items_per_bucket == 8 || items_per_bucket == 16,
+                "InterleavedDynamicCuckooFilter supports 2, 4, 8 or 16 items "
+                "per bucket");
+
+ public:
+  // Size of a fingerprint in bits
+  static const size_t k_bits_per_item = sizeof(uintx) * 8;
+  // Number of slots in a bucket
+  static const size_t k_items_per_bucket = items_per_bucket;
+
+ private:
+  // LevelTable is the table of one level as eviction_type sees it: bucket i
+  // of the level is the level-th bucket of row i
+  class LevelTable {
+    InterleavedDynamicCuckooFilter& dcf;
+    const size_t level;
+
+   public:
+    static const size_t k_items_per_bucket = items_per_bucket;
+
+    LevelTable(InterleavedDynamicCuckooFilter& dcf, const size_t& level)
+        : dcf(dcf), level(level) {}
+
+    uintx* Bucket(const uint32_t& i) const {
+      return dcf.Row(i) + level * k_items_per_bucket;
+    }
+
+    uint32_t ReadItem(const uint32_t& i, const uint32_t& j) const {
+      return Bucket(i)[j];
+    }
+
+    void Prefetch(const uint32_t& i) const { __builtin_prefetch(Bucket(i)); }
+
+    bool DeleteItemFromBucket(const uint32_t& i, const uint32_t& fingerprint) {
+      int j = simd::FindSlot<uintx, k_items_per_bucket>(Bucket(i), fingerprint);
+      if (j < 0) return false;
+
+      Bucket(i)[j] = 0;
+
+      return true;
+    }
+
+    // InsertItemToBucket works like Table::InsertItemToBucket
+    bool InsertItemToBucket(const uint32_t& i, const uint32_t& fingerprint,
+                            const bool& kickout, uint32_t& old_fingerprint) {
+      int j = simd::FindSlot<uintx, k_items_per_bucket>(Bucket(i), 0);
+      if (j >= 0) {
+        Bucket(i)[j] = fingerprint;
+
+        return true;
+      }
+
+      if (kickout) {
+        uint32_t r = rand() % k_items_per_bucket;
+        old_fingerprint = Bucket(i)[r];
+        Bucket(i)[r] = fingerprint;
+      }
+
+      return false;
+    }
+  };
+
+  // Level holds the item count and the stash of one level
+  class Level {
+   public:
+    size_t num_items;
+    Stash stash;
+
+    Level(const size_t& stash_size) : num_items(0), stash(stash_size) {}
+  };
+
+  using Rows = std::unique_ptr<uintx[], AllocatorDeleter<allocator_type>>;
+
+  // Load factor threshold is used to determine if a level is full or not
+  const double load_factor_threshold;
+  // Max items that each level can hold
+  const size_t max_items;
+  // Number of items each level keeps in its stash
+  const size_t stash_size;
+
+  size_t bucket_count;
+  uint32_t item_mask;
+  uint32_t index_mask;
+  layout_type layout;
+
+  // bucket_count rows of stride buckets
+  Rows rows;
+  size_t stride;
+
+  std::vector<Level> levels;
+  // Position of the current level (first level that is not full)
+  size_t curr_level;
+  // Number of stashed items of all levels, so lookups skip the stashes
+  // while none is in use
+  size_t stashed;
+
+  hash_used hasher;
+  eviction_type eviction;
+  size_t num_kicks;
+
+  // Row returns the first bucket of row i
+  uintx* Row(const uint32_t& i) const {
+    return rows.get() + (size_t)i * stride * k_items_per_bucket;
+  }
+
+  // RowBytes returns bytes of a row used by the levels
+  size_t RowBytes() const {
+    return levels.size() * k_items_per_bucket * sizeof(uintx);
+  }
+
+  // AllocateRows allocates count zeroed fingerprints, aligned as layout_type
+  // needs
+  static Rows AllocateRows(const size_t& count) {
+    const size_t bytes = count * sizeof(uintx);
+    return Rows(static_cast<uintx*>(
+                    allocator_type::Allocate(bytes, layout_type::k_alignment)),
+                AllocatorDeleter<allocator_type>(bytes));
+  }
+
+  // Restride copies every row into a table with new_stride levels per row
+  void Restride(const size_t& new_stride) {
+    Rows restrided =
+        AllocateRows(bucket_count * new_stride * k_items_per_bucket);
+    const size_t row_bytes = RowBytes();
+
+    for (size_t i = 0; i < bucket_count; i++)
+      memcpy(restrided.get() + i * new_stride * k_items_per_bucket, Row(i),
+             row_bytes);
+
+    rows = std::move(restrided);
+    stride = new_stride;
+  }
+
+  // AdvanceCurrentLevel moves curr_level to the first level below the load
+  // factor threshold whose stash is not full, adding a level at the end (and
+  // re-striding the table if its rows are full) if there is none
+  void AdvanceCurrentLevel() {
+    while (1.0 * levels[curr_level].num_items / max_items >=
+               load_factor_threshold ||
+           levels[curr_level].num_items == max_items ||
+           levels[curr_level].stash.Full()) {
+      if (++curr_level == levels.size()) {
+        if (levels.size() == stride) Restride(2 * stride);
+        levels.emplace_back(stash_size);
+      }
+    }
+  }
+
+  // InsertIntoLevel adds an item to a level with eviction_type, or stashes it
+  // if eviction_type gives up. The stash of the level must not be full.
+  void InsertIntoLevel(const size_t& level, const uint32_t& index,
+                       const uint32_t& fingerprint) {
+    LevelTable table(*this, level);
+    uint32_t current_index = index;
+    uint32_t current_fingerprint = fingerprint;
+    auto alt_index = [this](const uint32_t& i, const uint32_t& fp) {
+      return layout.AltIndex(i, fp, index_mask);
+    };
+
+    levels[level].num_items++;
+    if (eviction.Insert(table, alt_index, current_index, current_fingerprint,
+                        num_kicks))
+      return;
+
+    levels[level].stash.Push(current_index, current_fingerprint);
+    stashed++;
+  }
+
+  // ReinsertStashed moves the last stashed item of a level back into its
+  // buckets after a delete made room there
+  void ReinsertStashed(const size_t& level) {
+    uint32_t index, fingerprint;
+    levels[level].stash.Back(index, fingerprint);
+    levels[level].stash.PopBack();
+    levels[level].num_items--;
+    stashed--;
+    InsertIntoLevel(level, index, fingerprint);
+  }
+
+ public:
+  // constructor creates the first level with room for max_items items;
+  // load_factor_threshold and stash_size work as in DynamicCuckooFilter
+  InterleavedDynamicCuckooFilter(const size_t max_items,
+                                 double load_factor_threshold = 0.9,
+                                 const size_t& stash_size = default_stash_size)
+      : load_factor_threshold(load_factor_threshold),
+        max_items(max_items),
+        stash_size(std::max<size_t>(stash_size, 1)),
+        stride(1),
+        curr_level(0),
+        stashed(0),
+        hasher(),
+        eviction(),
+        num_kicks(0) {
+    // Number of buckets is the power of 2 a CuckooFilter would use
+    bucket_count =
+        max_items < k_items_per_bucket
+            ? 1
+            : pow(2, ceil(log2(((double)max_items) / k_items_per_bucket)));
+    index_mask = bucket_count - 1;
+    item_mask = (1ULL << k_bits_per_item) - 1;
+    layout = layout_type(k_bits_per_item * k_items_per_bucket, bucket_count);
+
+    rows = AllocateRows(bucket_count * k_items_per_bucket);
+    levels.emplace_back(this->stash_size);
+  }
+
+  // destructor
+  virtual ~InterleavedDynamicCuckooFilter() = default;
+
+  // Add adds an item to the current level, adding a level first if the
+  // current one is at the load factor threshold or its stash is full.
+  // Note: This method call should always add an item
+  Status Add(const item_type& item) { return AddHash(hasher(item)); }
+
+  // Add, Contains and Delete also accept other keys that hash_used can hash
+  // without building an item_type (see CuckooFilter::Add)
+  template <typename Key>
+  Status Add(const Key& key) {
+    return AddHash(hasher(key));
+  }
+
+  Status Add(const char* data, const size_t& len) {
+    return AddHash(hasher(data, len));
+  }
+
+  // AddHash adds an item given by its 64-bit hash (as returned by hash_used)
+  Status AddHash(const uint64_t& hash) {
+    return AddHashedItem(GetHashedItem(hash));
+  }
+
+  // AddHashedItem adds a prehashed item
+  Status AddHashedItem(const HashedItem& hashed) {
+    AdvanceCurrentLevel();
+    InsertIntoLevel(curr_level, hashed.index1, hashed.fingerprint);
+
+    return Ok;
+  }
+
+  // GetHashedItem computes fingerprint and both indexes from a 64-bit hash
+  // the way CuckooFilter does
+  HashedItem GetHashedItem(const uint64_t& hash) const {
+    HashedItem hashed;
+    hashed.fingerprint = (hash >> 32) & item_mask;
+    // Fingerprint 0 marks an empty slot
+    if (hashed.fingerprint == 0) hashed.fingerprint = 1;
+    hashed.index1 = hash & index_mask;
+    hashed.index2 = layout.AltIndex(hashed.index1, hashed.fingerprint,
+                                    index_mask);
+    return hashed;
+  }
+
+  // PrefetchHashedItem asks the CPU to load the used part of both rows of a
+  // prehashed item
+  void PrefetchHashedItem(const HashedItem& hashed) const {
+    const size_t row_bytes = RowBytes();
+    const uint8_t* row1 = (const uint8_t*)Row(hashed.index1);
+    const uint8_t* row2 = (const uint8_t*)Row(hashed.index2);
+
+    for (size_t offset = 0; offset < row_bytes; offset += 64) {
+      __builtin_prefetch(row1 + offset);
+      __builtin_prefetch(row2 + offset);
+    }
+  }
+
+  // Contains checks if an item is in any level. If true return Ok, NotFound
+  // otherwise
+  Status Contains(const item_type& item) { return ContainsHash(hasher(item)); }
+
+  template <typename Key>
+  Status Contains(const Key& key) {
+    return ContainsHash(hasher(key));
+  }
+
+  Status Contains(const char* data, const size_t& len) {
+    return ContainsHash(hasher(data, len));
+  }
+
+  // ContainsHash checks if an item given by its 64-bit hash is in any level
+  Status ContainsHash(const uint64_t& hash) {
+    const HashedItem hashed = GetHashedItem(hash);
+    PrefetchHashedItem(hashed);
+
+    return ContainsHashedItem(hashed);
+  }
+
+  // ContainsHashedItem compares the rows of both buckets of a prehashed item,
+  // then the stashes if any item is stashed
+  Status ContainsHashedItem(const HashedItem& hashed) const {
+    const size_t count = levels.size() * k_items_per_bucket;
+
+    if (simd::FindInArray(Row(hashed.index1), count, hashed.fingerprint) >=
+            0 ||
+        simd::FindInArray(Row(hashed.index2), count, hashed.fingerprint) >= 0)
+      return Ok;
+
+    if (stashed > 0)
+      for (const Level& level : levels)
+        if (level.stash.Contain(hashed.fingerprint, hashed.index1,
+                                hashed.index2))
+          return Ok;
+
+    return NotFound;
+  }
+
+  // ContainsBatch checks count keys and writes the result of each into out.
+  // Keys are hashed and their rows prefetched a window of batch_window keys
+  // ahead, so the misses of a window overlap.
+  template <typename Key>
+  void ContainsBatch(const Key* keys, const size_t& count, Status* out) {
+    HashedItem hashed[batch_window];
+
+    for (size_t start = 0; start < count; start += batch_window) {
+      const size_t window = std::min(batch_window, count - start);
+
+      for (size_t i = 0; i < window; i++) {
+        hashed[i] = GetHashedItem(hasher(keys[start + i]));
+        PrefetchHashedItem(hashed[i]);
+      }
+      for (size_t i = 0; i < window; i++)
+        out[start + i] = ContainsHashedItem(hashed[i]);
+    }
+  }
+
+  // Delete deletes an item from the level that holds it. If the stash of the
+  // level was in use, one stashed item is added to the level again. If item
+  // deleted successfuly return Ok, NotFound otherwise
+  Status Delete(const item_type& item) { return DeleteHash(hasher(item)); }
+
+  template <typename Key>
+  Status Delete(const Key& key) {
+    return DeleteHash(hasher(key));
+  }
+
+  Status Delete(const char* data, const size_t& len) {
+    return DeleteHash(hasher(data, len));
+  }
+
+  // DeleteHash deletes an item given by its 64-bit hash
+  Status DeleteHash(const uint64_t& hash) {
+    return DeleteHashedItem(GetHashedItem(hash));
+  }
+
+  // DeleteHashedItem deletes a prehashed item
+  Status DeleteHashedItem(const HashedItem& hashed) {
+    const size_t count = levels.size() * k_items_per_bucket;
+
+    for (const uint32_t& index : {hashed.index1, hashed.index2}) {
+      uintx* row = Row(index);
+      const long position = simd::FindInArray(row, count, hashed.fingerprint);
+      if (position < 0) continue;
+
+      const size_t level = position / k_items_per_bucket;
+      row[position] = 0;
+      levels[level].num_items--;
+
+      if (!levels[level].stash.Empty()) ReinsertStashed(level);
+
+      return Ok;
+    }
+
+    if (stashed > 0) {
+      for (Level& level : levels) {
+        if (level.stash.Delete(hashed.fingerprint, hashed.index1,
+                               hashed.index2)) {
+          level.num_items--;
+          stashed--;
+          return Ok;
+        }
+      }
+    }
+
+    return NotFound;
+  }
+
+  // InsertSequence adds every k-mer of a sequence using a rolling ntHash. See
+  // CuckooFilter::InsertSequence.
+  Status InsertSequence(const std::string_view& seq, const size_t& k,
+                        const bool& canonical = false) {
+    RollingKmerHash rolling(seq.data(), seq.length(), k, canonical);
+
+    while (rolling.Next()) {
+      AddHash(rolling.Hash());
+    }
+
+    return Ok;
+  }
+
+  // QuerySequence checks every k-mer of a sequence. Element i of the result is
+  // true if the k-mer starting at position i was added.
+  std::vector<bool> QuerySequence(const std::string_view& seq, const size_t& k,
+                                  const bool& canonical = false) {
+    std::vector<bool> found(seq.length() >= k ? seq.length() - k + 1 : 0);
+    RollingKmerHash rolling(seq.data(), seq.length(), k, canonical);
+
+    while (rolling.Next()) {
+      found[rolling.Position()] = ContainsHash(rolling.Hash()) == Ok;
+    }
+
+    return found;
+  }
+
+  vector<size_t> const SizeOfEachCF() {
+    vector<size_t> sizes;
+    for (const Level& level : levels) sizes.push_back(level.num_items);
+    return sizes;
+  }
+  size_t TotalSize() {
+    size_t sizes = 0;
+    for (const Level& level : levels) sizes += level.num_items;
+    return sizes;
+  }
+  // TotalSizeInBytes includes rows reserved for levels not added yet
+  size_t TotalSizeInBytes() const {
+    return bucket_count * stride * k_items_per_bucket * sizeof(uintx);
+  }
+  size_t TotalKicks() const { return num_kicks; }
+
+  // Stride returns how many levels a row has room for
+  size_t Stride() const { return stride; }
+
+  string Info() {
+    std::stringstream ss;
+
+    ss << "InterleavedDynamicCuckooFilter Status:" << std::endl;
+    ss << "\t\tFingerprint size: " << k_bits_per_item << " bits\n";
+    ss << "\t\tItems per bucket: " << k_items_per_bucket << "\n";
+    ss << "\t\tTotal # of rows: " << bucket_count << "\n";
+    ss << "\t\tLevels: " << levels.size() << " of " << stride << "\n";
+    int br = 1;
+    for (const Level& level : levels) {
+      ss << "\t\tLevel " << br++ << ": " << level.num_items << " items, "
+         << level.stash.Size() << " stashed\n";
+    }
+
+    return ss.str();
+  }
+};
+}  // namespace cuckoofilterbio1
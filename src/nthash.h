@@ -0,0 +1,161 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <string>
+#include <string_view>
+
+#include "hash.h"
+#include "packed-kmer.h"
+
+namespace cuckoofilterbio1 {
+namespace ntdetail {
+// Seeds of ntHash (Mohamadi et al. 2016) for A, C, G and T, indexed by the
+// 2-bit code from EncodeBase. Complement of base b is 3 - b.
+const uint64_t k_seeds[4] = {0x3c8bfbb395c60474ULL, 0x3193c18562a02b4cULL,
+                             0x20323ed082572324ULL, 0x295549f54be24456ULL};
+
+inline uint64_t Rotl(const uint64_t& x, const size_t& r) {
+  const size_t s = r & 63;
+  return s == 0 ? x : (x << s) | (x >> (64 - s));
+}
+
+inline uint64_t Rotr(const uint64_t& x, const size_t& r) {
+  const size_t s = r & 63;
+  return s == 0 ? x : (x >> s) | (x << (64 - s));
+}
+
+// ForwardHash computes ntHash of the k bases at data from scratch
+inline uint64_t ForwardHash(const char* data, const size_t& k) {
+  uint64_t h = 0;
+  for (size_t i = 0; i < k; i++)
+    h ^= Rotl(k_seeds[EncodeBase(data[i]) & 3], k - 1 - i);
+  return h;
+}
+
+// ReverseHash computes ntHash of the reverse complement of the k bases at data
+inline uint64_t ReverseHash(const char* data, const size_t& k) {
+  uint64_t h = 0;
+  for (size_t i = 0; i < k; i++)
+    h ^= Rotl(k_seeds[3 - (EncodeBase(data[i]) & 3)], i);
+  return h;
+}
+
+// Finalize mixes a raw ntHash value so both halves of it can be used for the
+// bucket index and the fingerprint
+inline uint64_t Finalize(const uint64_t& forward, const uint64_t& reverse,
+                         const bool& canonical) {
+  return hashdetail::Fmix64(canonical ? forward + reverse : forward);
+}
+}  // namespace ntdetail
+
+// class RollingKmerHash iterates over all k-mers of a sequence and computes
+// their ntHash values in O(1) per k-mer by rolling the previous value. K-mers
+// that contain something else than A, C, G or T are skipped. If canonical is
+// true, a k-mer and its reverse complement get the same hash.
+//
+// Usage:
+//   RollingKmerHash rolling(seq.data(), seq.size(), k, canonical);
+//   while (rolling.Next()) use(rolling.Position(), rolling.Hash());
+class RollingKmerHash {
+  const char* seq;
+  size_t len;
+  size_t k;
+  bool canonical;
+
+  size_t pos;
+  bool started;
+  uint64_t forward;
+  uint64_t reverse;
+
+  // Init finds the first k-mer at or after start without invalid bases and
+  // computes its hashes from scratch
+  bool Init(size_t start) {
+    size_t valid = 0;
+
+    for (size_t i = start; i < len; i++) {
+      if (EncodeBase(seq[i]) > 3) {
+        valid = 0;
+        continue;
+      }
+
+      if (++valid == k) {
+        pos = i + 1 - k;
+        forward = ntdetail::ForwardHash(seq + pos, k);
+        reverse = ntdetail::ReverseHash(seq + pos, k);
+        return true;
+      }
+    }
+
+    pos = len;
+    return false;
+  }
+
+ public:
+  RollingKmerHash(const char* seq, const size_t& len, const size_t& k,
+                  const bool& canonical = false)
+      : seq(seq),
+        len(len),
+        k(k),
+        canonical(canonical),
+        pos(0),
+        started(false),
+        forward(0),
+        reverse(0) {}
+
+  // Next moves to the next valid k-mer; returns false once the end of the
+  // sequence is reached
+  bool Next() {
+    if (k == 0 || k > len) return false;
+
+    if (!started) {
+      started = true;
+      return Init(0);
+    }
+
+    if (pos + k >= len) {
+      pos = len;
+      return false;
+    }
+
+    uint8_t in = EncodeBase(seq[pos + k]);
+    if (in > 3) return Init(pos + k + 1);
+
+    uint8_t out = EncodeBase(seq[pos]);
+    forward = ntdetail::Rotl(forward, 1) ^
+              ntdetail::Rotl(ntdetail::k_seeds[out], k) ^
+              ntdetail::k_seeds[in];
+    reverse = ntdetail::Rotr(reverse, 1) ^
+              ntdetail::Rotr(ntdetail::k_seeds[3 - out], 1) ^
+              ntdetail::Rotl(ntdetail::k_seeds[3 - in], k - 1);
+    pos++;
+
+    return true;
+  }
+
+  // Position returns start of the current k-mer in the sequence
+  size_t Position() const { return pos; }
+
+  // Hash returns 64-bit hash of the current k-mer
+  uint64_t Hash() const {
+    return ntdetail::Finalize(forward, reverse, canonical);
+  }
+};
+
+// NtHash is a hash policy that hashes a whole string as one k-mer with the
+// same function as RollingKmerHash, so k-mers added with InsertSequence can
+// also be queried one by one with Contain. Use NtHash<true> for canonical
+// k-mers.
+template <bool canonical = false>
+class NtHash {
+ public:
+  uint64_t operator()(const std::string_view& s) const {
+    return (*this)(s.data(), s.length());
+  }
+
+  uint64_t operator()(const char* data, const size_t& len) const {
+    return ntdetail::Finalize(ntdetail::ForwardHash(data, len),
+                              ntdetail::ReverseHash(data, len), canonical);
+  }
+};
+}  // namespace cuckoofilterbio1
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "hash.h"
+
+namespace cuckoofilterbio1 {
+// EncodeBase returns 2-bit code of a nucleotide (A=0, C=1, G=2, T=3) or 4 if
+// the character is not a nucleotide. Complement of a base b is 3 - b.
+inline uint8_t EncodeBase(const char& base) {
+  switch (base) {
+    case 'A':
+    case 'a':
+      return 0;
+    case 'C':
+    case 'c':
+      return 1;
+    case 'G':
+    case 'g':
+      return 2;
+    case 'T':
+    case 't':
+      return 3;
+    default:
+      return 4;
+  }
+}
+
+// class PackedKmer stores a DNA k-mer of at most max_k bases with 2 bits per
+// base in 64-bit words (32 bases per word). Base i is stored in word i / 32 at
+// bit 2 * (i % 32), unused bits are always 0. The storage is fixed so a
+// PackedKmer never allocates; it takes 4x less memory than a std::string of
+// max_k characters.
+template <size_t max_k = 32>
+class PackedKmer {
+ public:
+  static const size_t k_words = (max_k + 31) / 32;
+
+ private:
+  uint64_t words[k_words];
+  uint32_t length;
+
+ public:
+  // PackedKmer constructor creates an empty k-mer
+  PackedKmer() : length(0) { memset(words, 0, sizeof(words)); }
+
+  // PackedKmer constructor packs len bases from data. Throws
+  // std::invalid_argument if the sequence is longer than max_k or contains
+  // something else than A, C, G or T.
+  PackedKmer(const char* data, const size_t& len) : PackedKmer() {
+    if (len > max_k)
+      throw std::invalid_argument("PackedKmer: sequence longer than max_k");
+
+    for (size_t i = 0; i < len; i++) {
+      uint64_t base = EncodeBase(data[i]);
+      if (base > 3)
+        throw std::invalid_argument("PackedKmer: invalid nucleotide");
+
+      words[i / 32] |= base << (2 * (i % 32));
+    }
+    length = len;
+  }
+
+  explicit PackedKmer(const std::string& sequence)
+      : PackedKmer(sequence.data(), sequence.length()) {}
+
+  // Length returns number of bases in the k-mer
+  size_t Length() const { return length; }
+
+  // WordCount returns number of words used by the k-mer
+  size_t WordCount() const { return (length + 31) / 32; }
+
+  // Words returns packed words of the k-mer
+  const uint64_t* Words() const { return words; }
+
+  // Base returns 2-bit code of base i
+  uint8_t Base(const size_t& i) const {
+    return (words[i / 32] >> (2 * (i % 32))) & 3;
+  }
+
+  // ToString unpacks the k-mer
+  std::string ToString() const {
+    static const char bases[] = "ACGT";
+    std::string s(length, 'A');
+    for (size_t i = 0; i < length; i++) s[i] = bases[Base(i)];
+    return s;
+  }
+
+  bool operator==(const PackedKmer& other) const {
+    return length == other.length &&
+           memcmp(words, other.words, sizeof(words)) == 0;
+  }
+
+  bool operator!=(const PackedKmer& other) const { return !(*this == other); }
+
+  // operator< orders k-mers by length and then by packed words so PackedKmer
+  // can be stored in a std::set
+  bool operator<(const PackedKmer& other) const {
+    if (length != other.length) return length < other.length;
+    for (size_t i = 0; i < k_words; i++)
+      if (words[i] != other.words[i]) return words[i] < other.words[i];
+    return false;
+  }
+};
+
+// KmerHash is a hash policy for PackedKmer: each used 64-bit word is folded
+// with one 128-bit multiplication (the same mixer as WyHash), so a k-mer of k
+// bases costs k / 32 multiplications instead of a byte loop. Strings are
+// hashed with WyHash.
+class KmerHash : public HashFunction<WyHash> {
+  static const uint64_t k_secret0 = 0xa0761d6478bd642fULL;
+  static const uint64_t k_secret1 = 0xe7037ed1a0b428dbULL;
+
+ public:
+  using HashFunction<WyHash>::operator();
+
+  template <size_t max_k>
+  uint64_t operator()(const PackedKmer<max_k>& kmer) const {
+    const uint64_t* words = kmer.Words();
+    const size_t word_count = kmer.WordCount();
+    uint64_t seed = k_secret0 ^ kmer.Length();
+
+    for (size_t i = 0; i < word_count; i++)
+      seed = hashdetail::Mix(words[i] ^ k_secret1, seed ^ k_secret0);
+
+    return hashdetail::Mix(seed ^ k_secret1, kmer.Length() ^ k_secret0);
+  }
+};
+}  // namespace cuckoofilterbio1
@@ -0,0 +1,220 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace cuckoofilterbio1 {
+// Bucket probing kernels used by Table. A bucket is an array of `slots`
+// fingerprints of type uintx. The implementation is selected at compile time
+// from the bucket size in bytes:
+// - up to 8 bytes (e.g. 4 x uint8_t, 4 x uint16_t): SWAR on one 64-bit word
+// - multiples of 32 bytes with AVX2, multiples of 16 bytes with SSE2:
+//   compare and movemask
+// - otherwise: SWAR on 8-byte chunks
+namespace simd {
+// Lanes returns a word with value repeated in every uintx lane
+template <typename uintx>
+constexpr uint64_t Lanes(const uint64_t &value) {
+  return sizeof(uintx) == 1   ? value * 0x0101010101010101ULL
+         : sizeof(uintx) == 2 ? value * 0x0001000100010001ULL
+                              : value * 0x0000000100000001ULL;
+}
+
+// ZeroLanes returns a word with the high bit of every zero uintx lane of x
+// set. Lanes above the lowest zero lane may be reported falsely, so only the
+// lowest set bit (and whether any bit is set) is exact.
+template <typename uintx>
+inline uint64_t ZeroLanes(const uint64_t &x) {
+  const uint64_t high_bits = Lanes<uintx>(1ULL << (8 * sizeof(uintx) - 1));
+  return (x - Lanes<uintx>(1)) & ~x & high_bits;
+}
+
+// Load reads `bytes` bytes (at most 8) into the low bytes of a word
+template <size_t bytes>
+inline uint64_t Load(const void *p) {
+  uint64_t word = 0;
+  memcpy(&word, p, bytes);
+  return word;
+}
+
+// MatchWord returns a lowest-exact mask of lanes of word that are equal to
+// value; only the low `bytes` bytes of word are compared
+template <typename uintx, size_t bytes>
+inline uint64_t MatchWord(const uint64_t &word, const uint32_t &value) {
+  uint64_t x = word ^ Lanes<uintx>(value);
+  if (bytes < 8) x |= ~0ULL << (8 * bytes);
+  return ZeroLanes<uintx>(x);
+}
+
+#if defined(__SSE2__)
+// MatchMask16 returns a byte mask of the uintx lanes of v equal to value
+template <typename uintx>
+inline uint32_t MatchMask16(const __m128i &v, const uint32_t &value) {
+  if (sizeof(uintx) == 1)
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8((char)value)));
+  if (sizeof(uintx) == 2)
+    return _mm_movemask_epi8(
+        _mm_cmpeq_epi16(v, _mm_set1_epi16((short)value)));
+  return _mm_movemask_epi8(_mm_cmpeq_epi32(v, _mm_set1_epi32((int)value)));
+}
+#endif
+
+#if defined(__AVX2__)
+// MatchMask32 returns a byte mask of the uintx lanes of v equal to value
+template <typename uintx>
+inline uint32_t MatchMask32(const __m256i &v, const uint32_t &value) {
+  if (sizeof(uintx) == 1)
+    return _mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(v, _mm256_set1_epi8((char)value)));
+  if (sizeof(uintx) == 2)
+    return _mm256_movemask_epi8(
+        _mm256_cmpeq_epi16(v, _mm256_set1_epi16((short)value)));
+  return _mm256_movemask_epi8(
+      _mm256_cmpeq_epi32(v, _mm256_set1_epi32((int)value)));
+}
+#endif
+
+// FindSlot returns index of the first slot of bucket equal to value, or -1
+template <typename uintx, size_t slots>
+inline int FindSlot(const uintx *bucket, const uint32_t &value) {
+  constexpr size_t bytes = slots * sizeof(uintx);
+
+  if constexpr (bytes <= 8) {
+    uint64_t mask = MatchWord<uintx, bytes>(Load<bytes>(bucket), value);
+    return mask ? (int)(__builtin_ctzll(mask) / (8 * sizeof(uintx))) : -1;
+  }
+#if defined(__AVX2__)
+  else if constexpr (bytes % 32 == 0) {
+    for (size_t chunk = 0; chunk < bytes; chunk += 32) {
+      __m256i v = _mm256_loadu_si256(
+          (const __m256i *)((const uint8_t *)bucket + chunk));
+      uint32_t mask = MatchMask32<uintx>(v, value);
+      if (mask) return (int)((chunk + __builtin_ctz(mask)) / sizeof(uintx));
+    }
+    return -1;
+  }
+#endif
+#if defined(__SSE2__)
+  else if constexpr (bytes % 16 == 0) {
+    for (size_t chunk = 0; chunk < bytes; chunk += 16) {
+      __m128i v = _mm_loadu_si128(
+          (const __m128i *)((const uint8_t *)bucket + chunk));
+      uint32_t mask = MatchMask16<uintx>(v, value);
+      if (mask) return (int)((chunk + __builtin_ctz(mask)) / sizeof(uintx));
+    }
+    return -1;
+  }
+#endif
+  else {
+    for (size_t chunk = 0; chunk < bytes; chunk += 8) {
+      uint64_t mask = MatchWord<uintx, 8>(
+          Load<8>((const uint8_t *)bucket + chunk), value);
+      if (mask)
+        return (int)((8 * chunk + __builtin_ctzll(mask)) / (8 * sizeof(uintx)));
+    }
+    return -1;
+  }
+}
+
+// FindInBuckets returns true if value is in bucket1 or bucket2. If both
+// buckets fit into one register they are compared together.
+template <typename uintx, size_t slots>
+inline bool FindInBuckets(const uintx *bucket1, const uintx *bucket2,
+                          const uint32_t &value) {
+  constexpr size_t bytes = slots * sizeof(uintx);
+
+  if constexpr (bytes <= 4) {
+    uint64_t word = Load<bytes>(bucket1) | Load<bytes>(bucket2) << (8 * bytes);
+    return MatchWord<uintx, 2 * bytes>(word, value) != 0;
+  }
+#if defined(__SSE2__)
+  else if constexpr (bytes == 8) {
+    __m128i v = _mm_set_epi64x((long long)Load<8>(bucket2),
+                               (long long)Load<8>(bucket1));
+    return MatchMask16<uintx>(v, value) != 0;
+  }
+#endif
+#if defined(__AVX2__)
+  else if constexpr (bytes == 16) {
+    __m256i v = _mm256_set_m128i(_mm_loadu_si128((const __m128i *)bucket2),
+                                 _mm_loadu_si128((const __m128i *)bucket1));
+    return MatchMask32<uintx>(v, value) != 0;
+  }
+#endif
+  else {
+    return FindSlot<uintx, slots>(bucket1, value) >= 0 ||
+           FindSlot<uintx, slots>(bucket2, value) >= 0;
+  }
+}
+
+// FindInArray returns the position of the first of count fingerprints at p
+// equal to value, or -1. Used to compare a whole row of buckets at once.
+template <typename uintx>
+inline long FindInArray(const uintx *p, const size_t &count,
+                        const uint32_t &value) {
+  const size_t bytes = count * sizeof(uintx);
+  size_t chunk = 0;
+#if defined(__AVX2__)
+  for (; chunk + 32 <= bytes; chunk += 32) {
+    __m256i v =
+        _mm256_loadu_si256((const __m256i *)((const uint8_t *)p + chunk));
+    uint32_t mask = MatchMask32<uintx>(v, value);
+    if (mask) return (long)((chunk + __builtin_ctz(mask)) / sizeof(uintx));
+  }
+#endif
+#if defined(__SSE2__)
+  for (; chunk + 16 <= bytes; chunk += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *)((const uint8_t *)p + chunk));
+    uint32_t mask = MatchMask16<uintx>(v, value);
+    if (mask) return (long)((chunk + __builtin_ctz(mask)) / sizeof(uintx));
+  }
+#endif
+  for (; chunk + 8 <= bytes; chunk += 8) {
+    uint64_t mask =
+        MatchWord<uintx, 8>(Load<8>((const uint8_t *)p + chunk), value);
+    if (mask)
+      return (long)((8 * chunk + __builtin_ctzll(mask)) / (8 * sizeof(uintx)));
+  }
+  for (size_t i = chunk / sizeof(uintx); i < count; i++)
+    if (p[i] == value) return (long)i;
+  return -1;
+}
+
+// FindEntry returns the first position i below count (a multiple of 4) where
+// fingerprints[i] is fingerprint and indexes[i] is index1 or index2, or -1.
+// Used by Stash, whose arrays are padded with fingerprint 0.
+inline int FindEntry(const uint32_t *fingerprints, const uint32_t *indexes,
+                     const size_t &count, const uint32_t &fingerprint,
+                     const uint32_t &index1, const uint32_t &index2) {
+#if defined(__SSE2__)
+  const __m128i fp = _mm_set1_epi32((int)fingerprint);
+  const __m128i i1 = _mm_set1_epi32((int)index1);
+  const __m128i i2 = _mm_set1_epi32((int)index2);
+  for (size_t i = 0; i < count; i += 4) {
+    const __m128i f = _mm_loadu_si128((const __m128i *)(fingerprints + i));
+    const __m128i x = _mm_loadu_si128((const __m128i *)(indexes + i));
+    const __m128i match = _mm_and_si128(
+        _mm_cmpeq_epi32(f, fp),
+        _mm_or_si128(_mm_cmpeq_epi32(x, i1), _mm_cmpeq_epi32(x, i2)));
+    const uint32_t mask = _mm_movemask_ps(_mm_castsi128_ps(match));
+    if (mask != 0) return i + __builtin_ctz(mask);
+  }
+  return -1;
+#else
+  for (size_t i = 0; i < count; i++)
+    if (fingerprints[i] == fingerprint &&
+        (indexes[i] == index1 || indexes[i] == index2))
+      return i;
+  return -1;
+#endif
+}
+}  // namespace simd
+}  // namespace cuckoofilterbio1
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "simd.h"
+
+namespace cuckoofilterbio1 {
+// Stash holds items that found no slot in the table of a CF, as the
+// fingerprint and one of the two buckets of each. Lookups compare all
+// entries at once with simd::FindEntry, so the arrays are padded to a
+// multiple of 4 entries with fingerprint 0, which no item has.
+class Stash {
+  std::vector<uint32_t> fingerprints;
+  std::vector<uint32_t> indexes;
+  size_t capacity;
+  size_t size;
+
+ public:
+  Stash(const size_t &capacity = 1)
+      : fingerprints((capacity + 3) / 4 * 4, 0),
+        indexes((capacity + 3) / 4 * 4, 0),
+        capacity(capacity),
+        size(0) {}
+
+  // Size returns number of stashed items
+  size_t Size() const { return size; }
+
+  // Capacity returns how many items the stash can hold
+  size_t Capacity() const { return capacity; }
+
+  bool Empty() const { return size == 0; }
+
+  bool Full() const { return size == capacity; }
+
+  // Push stashes an item; returns false if the stash is full
+  bool Push(const uint32_t &index, const uint32_t &fingerprint) {
+    if (Full()) return false;
+    indexes[size] = index;
+    fingerprints[size] = fingerprint;
+    size++;
+    return true;
+  }
+
+  // Contain returns true if an item with fingerprint and bucket index1 or
+  // index2 is stashed
+  bool Contain(const uint32_t &fingerprint, const uint32_t &index1,
+               const uint32_t &index2) const {
+    if (size == 0) return false;
+    return simd::FindEntry(fingerprints.data(), indexes.data(),
+                           fingerprints.size(), fingerprint, index1,
+                           index2) >= 0;
+  }
+
+  // Delete removes an item with fingerprint and bucket index1 or index2;
+  // returns false if there is none. The last entry takes its place.
+  bool Delete(const uint32_t &fingerprint, const uint32_t &index1,
+              const uint32_t &index2) {
+    if (size == 0) return false;
+    const int i = simd::FindEntry(fingerprints.data(), indexes.data(),
+                                  fingerprints.size(), fingerprint, index1,
+                                  index2);
+    if (i < 0) return false;
+
+    size--;
+    indexes[i] = indexes[size];
+    fingerprints[i] = fingerprints[size];
+    fingerprints[size] = 0;
+    return true;
+  }
+
+  // Back returns the bucket and fingerprint of the last stashed item
+  void Back(uint32_t &index, uint32_t &fingerprint) const {
+    index = indexes[size - 1];
+    fingerprint = fingerprints[size - 1];
+  }
+
+  // Get returns the bucket and fingerprint of the i-th stashed item
+  void Get(const size_t &i, uint32_t &index, uint32_t &fingerprint) const {
+    index = indexes[i];
+    fingerprint = fingerprints[i];
+  }
+
+  // Set replaces the i-th stashed item
+  void Set(const size_t &i, const uint32_t &index,
+           const uint32_t &fingerprint) {
+    indexes[i] = index;
+    fingerprints[i] = fingerprint;
+  }
+
+  // PopBack removes the last stashed item
+  void PopBack() { fingerprints[--size] = 0; }
+};
+}  // namespace cuckoofilterbio1
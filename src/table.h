@@ -1,6 +1,9 @@
+#pragma once
+
 #include <math.h>
 #include <stdio.h>
 
+#include <algorithm>
 #include <cstring>
 #include <iostream>
 #include <memory>
@@ -8,13 +11,31 @@
 #include <sstream>
 #include <vector>
 
+#include "allocator.h"
+#include "simd.h"
+
 using namespace std;
 
 namespace cuckoofilterbio1 {
-template <class uintx = uint8_t>
-// Class Table is used for storing data into buckets.
+// Class Table is used for storing data into buckets. items_per_bucket sets
+// the bucket associativity (2, 4, 8 or 16 slots): more slots allow a higher
+// load factor, fewer slots give faster probes and a lower FPP.
+// allocator_type is an allocator policy from allocator.h; the default aligns
+// buckets to cache lines, MmapAllocator<true> backs the table with huge pages.
+template <class uintx = uint8_t, size_t items_per_bucket = 4,
+          class allocator_type = AlignedAllocator<>>
 class Table {
-  static const size_t k_items_per_bucket = 4;
+  static_assert(items_per_bucket == 2 || items_per_bucket == 4 ||
+                    items_per_bucket == 8 || items_per_bucket == 16,
+                "Table supports 2, 4, 8 or 16 items per bucket");
+
+ public:
+  // Size of a fingerprint in bits
+  static const size_t k_bits_per_item = sizeof(uintx) * 8;
+  // Number of slots in a bucket
+  static const size_t k_items_per_bucket = items_per_bucket;
+
+ private:
   size_t bits_per_item;
   size_t k_bytes_per_bucket;
 
@@ -23,18 +44,21 @@ class Table {
 
    public:
     uint32_t operator[](const uint32_t &j) { return bits[j]; }
+    const uintx *Data() const { return bits; }
     void write(const uint32_t &j, const uint32_t &fingerprint) {
       bits[j] = fingerprint;
     }
   };
 
-  std::unique_ptr<Bucket[]> buckets;
+  std::unique_ptr<Bucket[], AllocatorDeleter<allocator_type>> buckets;
   size_t bucket_count;
 
  public:
   // Table constructor takes bucket_count as a parameter and will create an
-  // empty array of buckets
-  Table(const size_t bucket_count) : bucket_count(bucket_count) {
+  // empty array of buckets. allocator_type returns zeroed memory, aligned to
+  // at least alignment bytes if that is not 0 (see BlockedLayout).
+  Table(const size_t bucket_count, const size_t& alignment = 0)
+      : bucket_count(bucket_count) {
     if (std::is_same<uintx, uint8_t>::value) {
       bits_per_item = 8;
     } else if (std::is_same<uintx, uint16_t>::value) {
@@ -44,8 +68,10 @@ class Table {
     }
     k_bytes_per_bucket = (bits_per_item * k_items_per_bucket) / 8.;
 
-    buckets = std::make_unique<Bucket[]>(bucket_count);
-    memset(buckets.get(), 0, k_bytes_per_bucket * bucket_count);
+    const size_t bytes = sizeof(Bucket) * bucket_count;
+    buckets = std::unique_ptr<Bucket[], AllocatorDeleter<allocator_type>>(
+        static_cast<Bucket *>(allocator_type::Allocate(bytes, alignment)),
+        AllocatorDeleter<allocator_type>(bytes));
   }
 
   // Table destructor
@@ -71,6 +97,9 @@ class Table {
     buckets[i].write(j, fingerprint);
   }
 
+  // Prefetch asks the CPU to load bucket i into the cache
+  void Prefetch(const uint32_t &i) const { __builtin_prefetch(&buckets[i]); }
+
   // GetBucket returns all items from bucket i
   vector<uint32_t> GetBucket(const uint32_t &i) {
     vector<uint32_t> bucket;
@@ -83,8 +112,180 @@ class Table {
 
   // DeleteItemFromBucket deletes an item (fingerprint) from bucket i
   bool DeleteItemFromBucket(const uint32_t &i, const uint32_t &fingerprint) {
+    int j = simd::FindSlot<uintx, k_items_per_bucket>(buckets[i].Data(),
+                                                      fingerprint);
+    if (j < 0) return false;
+
+    WriteItem(i, j, 0);
+
+    return true;
+  }
+
+  // FindFingerprintInBuckets returns a true if item is found in bucket i1 or
+  // i2, false otherwise. Both buckets are compared with SIMD/SWAR kernels
+  // from simd.h.
+  bool FindFingerprintInBuckets(const uint32_t &i1, const uint32_t &i2,
+                                const uint32_t &fingerprint) {
+    return simd::FindInBuckets<uintx, k_items_per_bucket>(
+        buckets[i1].Data(), buckets[i2].Data(), fingerprint);
+  }
+
+  // InsertItemToBucket inserts an item (fingerprint) to a bucket i. If
+  // insertion was successful, returns true. If insertions was unsuccessful,
+  // returns false and if kickout is true will make a kickout of a random item
+  // from bucket i.
+  bool InsertItemToBucket(const uint32_t &i, const uint32_t &fingerprint,
+                          const bool &kickout, uint32_t &old_fingerprint) {
+    int j = simd::FindSlot<uintx, k_items_per_bucket>(buckets[i].Data(), 0);
+    if (j >= 0) {
+      WriteItem(i, j, fingerprint);
+
+      return true;
+    }
+
+    if (kickout) {
+      uint32_t r = rand() % k_items_per_bucket;
+      old_fingerprint = ReadItem(i, r);
+      WriteItem(i, r, fingerprint);
+    }
+
+    return false;
+  }
+
+  std::string Info() const {
+    std::stringstream ss;
+    ss << "SingleHashtable with fingerprint size: " << bits_per_item
+       << " bits \n";
+    ss << "\t\tItems per bucket: " << k_items_per_bucket << "\n";
+    ss << "\t\tTotal # of rows: " << bucket_count << "\n";
+    ss << "\t\tTotal # slots: " << SizeTable() << "\n";
+    return ss.str();
+  }
+};
+
+// Class BitPackedTable stores fingerprints of any size from 4 to 32 bits
+// without rounding up to a whole uint8_t/uint16_t/uint32_t. Buckets of
+// items_per_bucket fingerprints are packed back to back into a byte array:
+// slot j of bucket i starts at bit (i * items_per_bucket + j) * bits_per_item.
+// It has the same interface as Table and can be used as table_type of a
+// CuckooFilter, e.g. CuckooFilter<uint16_t, std::string, BitPackedTable<12>>.
+template <size_t bits_per_item, size_t items_per_bucket = 4>
+class BitPackedTable {
+  static_assert(bits_per_item >= 4 && bits_per_item <= 32,
+                "BitPackedTable supports 4 to 32 bits per item");
+  static_assert(items_per_bucket == 2 || items_per_bucket == 4 ||
+                    items_per_bucket == 8 || items_per_bucket == 16,
+                "BitPackedTable supports 2, 4, 8 or 16 items per bucket");
+
+ public:
+  // Size of a fingerprint in bits
+  static const size_t k_bits_per_item = bits_per_item;
+  // Number of slots in a bucket
+  static const size_t k_items_per_bucket = items_per_bucket;
+
+ private:
+  static const size_t k_bits_per_bucket = bits_per_item * k_items_per_bucket;
+  static const uint64_t k_item_mask = (1ULL << bits_per_item) - 1;
+  // Reads and writes always touch 8 bytes, so the array is padded
+  static const size_t k_padding_bytes = 8;
+
+  using Data =
+      std::unique_ptr<uint8_t[], AllocatorDeleter<AlignedAllocator<>>>;
+  Data data;
+  size_t bucket_count;
+  size_t size_in_bytes;
+
+  // Load8 and Store8 read and write 8 unaligned bytes
+  uint64_t Load8(const size_t &byte) const {
+    uint64_t word;
+    memcpy(&word, data.get() + byte, sizeof(word));
+    return word;
+  }
+
+  void Store8(const size_t &byte, const uint64_t &word) {
+    memcpy(data.get() + byte, &word, sizeof(word));
+  }
+
+  // ReadBucket reads all fingerprints of bucket i. A bucket that spans at most
+  // 57 bits (e.g. 4 slots of up to 14 bits) fits into a single 8-byte load.
+  void ReadBucket(const uint32_t &i, uint32_t items[k_items_per_bucket]) const {
+    if (k_bits_per_bucket + 7 <= 64) {
+      const size_t bit = (size_t)i * k_bits_per_bucket;
+      const uint64_t word = Load8(bit >> 3) >> (bit & 7);
+      for (uint32_t j = 0; j < k_items_per_bucket; j++)
+        items[j] = (word >> (j * bits_per_item)) & k_item_mask;
+    } else {
+      for (uint32_t j = 0; j < k_items_per_bucket; j++)
+        items[j] = ReadItem(i, j);
+    }
+  }
+
+ public:
+  // BitPackedTable constructor takes bucket_count as a parameter and will
+  // create an empty array of buckets, aligned to a cache line or to
+  // alignment bytes if that is larger
+  BitPackedTable(const size_t bucket_count, const size_t& alignment = 0)
+      : bucket_count(bucket_count) {
+    size_in_bytes = (k_bits_per_bucket * bucket_count + 7) / 8;
+    const size_t bytes = size_in_bytes + k_padding_bytes;
+    data = Data(static_cast<uint8_t *>(
+                    AlignedAllocator<>::Allocate(bytes, alignment)),
+                AllocatorDeleter<AlignedAllocator<>>(bytes));
+  }
+
+  // BitPackedTable destructor
+  virtual ~BitPackedTable() = default;
+
+  // BucketCount returns number of bucket in a Table
+  size_t BucketCount() const { return bucket_count; }
+
+  // SizeTable returns total size of a Table (used and unused)
+  size_t SizeTable() const { return k_items_per_bucket * bucket_count; }
+
+  // SizeTable returns total size of a Table in bytes (used and unused)
+  size_t SizeInBytes() const { return size_in_bytes; }
+
+  // ReadItem returns an item at bucket i and column j
+  uint32_t ReadItem(const uint32_t &i, const uint32_t &j) const {
+    const size_t bit = ((size_t)i * k_items_per_bucket + j) * bits_per_item;
+    return (Load8(bit >> 3) >> (bit & 7)) & k_item_mask;
+  }
+
+  // WriteItem writes an item (fingerprint) at bucket i and column j
+  void WriteItem(const uint32_t &i, const uint32_t &j,
+                 const uint32_t &fingerprint) {
+    const size_t bit = ((size_t)i * k_items_per_bucket + j) * bits_per_item;
+    const size_t shift = bit & 7;
+    uint64_t word = Load8(bit >> 3);
+    word &= ~(k_item_mask << shift);
+    word |= (fingerprint & k_item_mask) << shift;
+    Store8(bit >> 3, word);
+  }
+
+  // Prefetch asks the CPU to load bucket i into the cache
+  void Prefetch(const uint32_t &i) const {
+    __builtin_prefetch(data.get() + (((size_t)i * k_bits_per_bucket) >> 3));
+  }
+
+  // GetBucket returns all items from bucket i
+  vector<uint32_t> GetBucket(const uint32_t &i) const {
+    uint32_t items[k_items_per_bucket];
+    vector<uint32_t> bucket;
+
+    ReadBucket(i, items);
+    for (uint32_t j = 0; j < k_items_per_bucket; j++)
+      if (items[j] != 0) bucket.push_back(items[j]);
+
+    return bucket;
+  }
+
+  // DeleteItemFromBucket deletes an item (fingerprint) from bucket i
+  bool DeleteItemFromBucket(const uint32_t &i, const uint32_t &fingerprint) {
+    uint32_t items[k_items_per_bucket];
+
+    ReadBucket(i, items);
     for (uint32_t j = 0; j < k_items_per_bucket; j++) {
-      if (ReadItem(i, j) == fingerprint) {
+      if (items[j] == fingerprint) {
         WriteItem(i, j, 0);
 
         return true;
@@ -97,10 +298,13 @@ class Table {
   // FindFingerprintInBuckets returns a true if item is found in bucket i1 or
   // i2, false otherwise
   bool FindFingerprintInBuckets(const uint32_t &i1, const uint32_t &i2,
-                                const uint32_t &fingerprint) {
+                                const uint32_t &fingerprint) const {
+    uint32_t items1[k_items_per_bucket], items2[k_items_per_bucket];
+
+    ReadBucket(i1, items1);
+    ReadBucket(i2, items2);
     for (uint32_t j = 0; j < k_items_per_bucket; j++) {
-      if (ReadItem(i1, j) == fingerprint || ReadItem(i2, j) == fingerprint)
-        return true;
+      if (items1[j] == fingerprint || items2[j] == fingerprint) return true;
     }
 
     return false;
@@ -112,8 +316,11 @@ class Table {
   // from bucket i.
   bool InsertItemToBucket(const uint32_t &i, const uint32_t &fingerprint,
                           const bool &kickout, uint32_t &old_fingerprint) {
+    uint32_t items[k_items_per_bucket];
+
+    ReadBucket(i, items);
     for (uint32_t j = 0; j < k_items_per_bucket; j++) {
-      if (ReadItem(i, j) == 0) {
+      if (items[j] == 0) {
         WriteItem(i, j, fingerprint);
 
         return true;
@@ -122,7 +329,7 @@ class Table {
 
     if (kickout) {
       uint32_t r = rand() % k_items_per_bucket;
-      old_fingerprint = ReadItem(i, r);
+      old_fingerprint = items[r];
       WriteItem(i, r, fingerprint);
     }
 
@@ -131,12 +338,340 @@ class Table {
 
   std::string Info() const {
     std::stringstream ss;
-    ss << "SingleHashtable with fingerprint size: " << bits_per_item
+    ss << "BitPackedTable with fingerprint size: " << bits_per_item
+       << " bits \n";
+    ss << "\t\tItems per bucket: " << k_items_per_bucket << "\n";
+    ss << "\t\tTotal # of rows: " << bucket_count << "\n";
+    ss << "\t\tTotal # slots: " << SizeTable() << "\n";
+    return ss.str();
+  }
+};
+
+namespace packeddetail {
+// Number of bits used to encode the 4 sorted 4-bit prefixes of a bucket.
+// There are C(16 + 4 - 1, 4) = 3876 sorted sequences, which fit into 12 bits
+// instead of 16.
+const size_t k_code_bits = 12;
+const size_t k_code_count = 3876;
+
+// class SemiSortCodes maps 4 sorted 4-bit prefixes (a <= b <= c <= d) to a
+// 12-bit code and back. The code is the colex rank of the strictly increasing
+// sequence (a, b + 1, c + 2, d + 3), so encoding only needs 4 lookups in
+// small binomial tables and no 64K-entry table.
+class SemiSortCodes {
+  // binomial[r][n] = C(n + r - 1, r) for n from 0 to 15
+  uint16_t binomial[5][16];
+  // decode[code] holds 4 prefixes packed as a | b << 4 | c << 8 | d << 12
+  uint16_t decode[k_code_count];
+
+ public:
+  SemiSortCodes() {
+    for (size_t r = 1; r <= 4; r++) {
+      for (size_t n = 0; n < 16; n++) {
+        // C(n + r - 1, r)
+        uint32_t c = 1;
+        for (size_t i = 0; i < r; i++) c = c * (n + r - 1 - i) / (i + 1);
+        binomial[r][n] = c;
+      }
+    }
+
+    for (uint32_t a = 0; a < 16; a++)
+      for (uint32_t b = a; b < 16; b++)
+        for (uint32_t c = b; c < 16; c++)
+          for (uint32_t d = c; d < 16; d++)
+            decode[Encode(a, b, c, d)] = a | b << 4 | c << 8 | d << 12;
+  }
+
+  // Encode returns the code of 4 sorted prefixes
+  uint32_t Encode(const uint32_t &a, const uint32_t &b, const uint32_t &c,
+                  const uint32_t &d) const {
+    return binomial[1][a] + binomial[2][b] + binomial[3][c] + binomial[4][d];
+  }
+
+  // Decode returns 4 sorted prefixes packed into 4-bit lanes
+  uint32_t Decode(const uint32_t &code) const { return decode[code]; }
+};
+
+// Codes returns the tables shared by all PackedTables
+inline const SemiSortCodes &Codes() {
+  static const SemiSortCodes codes;
+  return codes;
+}
+}  // namespace packeddetail
+
+// Class PackedTable implements semi-sorted buckets from Fan et al. 2014
+// ("Cuckoo Filter: Practically Better Than Bloom"). The 4 fingerprints of a
+// bucket are sorted by their low 4 bits (prefix); the sorted prefixes are
+// stored as one 12-bit code and the remaining bits_per_item - 4 bits of every
+// fingerprint are stored as is, saving 1 bit per item. Buckets are packed
+// back to back into a byte array like in BitPackedTable. Slot j refers to the
+// j-th fingerprint in sorted order, so writing a slot may reorder the bucket.
+// It has the same interface as Table and can be used as table_type of a
+// CuckooFilter, e.g. CuckooFilter<uint16_t, std::string, PackedTable<13>>.
+template <size_t bits_per_item>
+class PackedTable {
+  static_assert(bits_per_item >= 5 && bits_per_item <= 16,
+                "PackedTable supports 5 to 16 bits per item");
+
+ public:
+  // Size of a fingerprint in bits
+  static const size_t k_bits_per_item = bits_per_item;
+  // Number of slots in a bucket
+  static const size_t k_items_per_bucket = 4;
+
+ private:
+  static const size_t k_prefix_bits = 4;
+  static const size_t k_suffix_bits = bits_per_item - k_prefix_bits;
+  static const size_t k_bits_per_bucket =
+      packeddetail::k_code_bits + k_items_per_bucket * k_suffix_bits;
+  static const uint64_t k_bucket_mask = (1ULL << k_bits_per_bucket) - 1;
+  static const uint32_t k_prefix_mask = (1U << k_prefix_bits) - 1;
+  static const uint32_t k_suffix_mask = (1U << k_suffix_bits) - 1;
+  // Lowest bit, high bit and all other bits of the 4 suffix lanes
+  static const uint64_t k_suffix_lanes_one =
+      1 | 1ULL << k_suffix_bits | 1ULL << (2 * k_suffix_bits) |
+      1ULL << (3 * k_suffix_bits);
+  static const uint64_t k_suffix_lanes_high = k_suffix_lanes_one
+                                              << (k_suffix_bits - 1);
+  static const uint64_t k_suffix_lanes_low =
+      k_suffix_lanes_high - k_suffix_lanes_one;
+  // A bucket starting at bit offset 7 can span 9 bytes, so the array is
+  // padded for the extra byte after an 8-byte load
+  static const size_t k_padding_bytes = 16;
+
+  using Data =
+      std::unique_ptr<uint8_t[], AllocatorDeleter<AlignedAllocator<>>>;
+  Data data;
+  size_t bucket_count;
+  size_t size_in_bytes;
+  const packeddetail::SemiSortCodes *codes;
+
+  // LoadBucket reads the raw bits of bucket i
+  uint64_t LoadBucket(const uint32_t &i) const {
+    const size_t bit = (size_t)i * k_bits_per_bucket;
+    const size_t byte = bit >> 3, shift = bit & 7;
+    uint64_t word;
+    memcpy(&word, data.get() + byte, sizeof(word));
+    word >>= shift;
+    if (shift + k_bits_per_bucket > 64)
+      word |= (uint64_t)data[byte + 8] << (64 - shift);
+    return word & k_bucket_mask;
+  }
+
+  // StoreBucket writes the raw bits of bucket i
+  void StoreBucket(const uint32_t &i, const uint64_t &bucket) {
+    const size_t bit = (size_t)i * k_bits_per_bucket;
+    const size_t byte = bit >> 3, shift = bit & 7;
+    uint64_t word;
+    memcpy(&word, data.get() + byte, sizeof(word));
+    word &= ~(k_bucket_mask << shift);
+    word |= bucket << shift;
+    memcpy(data.get() + byte, &word, sizeof(word));
+    if (shift + k_bits_per_bucket > 64) {
+      const uint8_t high_mask = k_bucket_mask >> (64 - shift);
+      data[byte + 8] = (data[byte + 8] & ~high_mask) |
+                       ((bucket >> (64 - shift)) & high_mask);
+    }
+  }
+
+  // DecodeBucket decodes all fingerprints of bucket i in sorted order into the
+  // four 16-bit lanes of a word. The 4-bit prefixes and the suffixes are
+  // spread into lanes with shifts and masks instead of a loop.
+  uint64_t DecodeBucket(const uint32_t &i) const {
+    const uint64_t bucket = LoadBucket(i);
+    const uint64_t suffix_pair_mask = k_suffix_mask | (uint64_t)k_suffix_mask
+                                                          << 32;
+
+    uint64_t prefixes =
+        codes->Decode(bucket & ((1U << packeddetail::k_code_bits) - 1));
+    prefixes = (prefixes | prefixes << 24) & 0x000000FF000000FFULL;
+    prefixes = (prefixes | prefixes << 12) & 0x000F000F000F000FULL;
+
+    uint64_t suffixes = bucket >> packeddetail::k_code_bits;
+    suffixes = (suffixes & ((1ULL << (2 * k_suffix_bits)) - 1)) |
+               (suffixes >> (2 * k_suffix_bits)) << 32;
+    suffixes = (suffixes & suffix_pair_mask) |
+               ((suffixes >> k_suffix_bits) & suffix_pair_mask) << 16;
+
+    return prefixes | suffixes << k_prefix_bits;
+  }
+
+  // MatchBucket returns true if fingerprint is in the raw bucket. Suffixes
+  // are compared first, all 4 at once with SWAR on k_suffix_bits wide lanes,
+  // and the prefix code is decoded only if a suffix matched.
+  bool MatchBucket(const uint64_t &bucket, const uint32_t &fingerprint) const {
+    const uint64_t x = (bucket >> packeddetail::k_code_bits) ^
+                       (fingerprint >> k_prefix_bits) * k_suffix_lanes_one;
+    // a lane of x is zero iff its high bit is clear after adding all ones to
+    // its low bits; the sum never carries into the next lane
+    uint64_t matches = ~(((x & k_suffix_lanes_low) + k_suffix_lanes_low) | x |
+                         k_suffix_lanes_low) &
+                       k_suffix_lanes_high;
+    if (!matches) return false;
+
+    const uint32_t prefixes =
+        codes->Decode(bucket & ((1U << packeddetail::k_code_bits) - 1));
+    for (; matches; matches &= matches - 1) {
+      const uint32_t j = __builtin_ctzll(matches) / k_suffix_bits;
+      if (((prefixes >> (j * k_prefix_bits)) & k_prefix_mask) ==
+          (fingerprint & k_prefix_mask))
+        return true;
+    }
+
+    return false;
+  }
+
+  // ReadBucket decodes all fingerprints of bucket i in sorted order
+  void ReadBucket(const uint32_t &i, uint32_t items[k_items_per_bucket]) const {
+    const uint64_t lanes = DecodeBucket(i);
+    for (uint32_t j = 0; j < k_items_per_bucket; j++)
+      items[j] = (lanes >> (16 * j)) & 0xffff;
+  }
+
+  // WriteBucket sorts fingerprints by prefix and encodes them into bucket i
+  void WriteBucket(const uint32_t &i, uint32_t items[k_items_per_bucket]) {
+    // sorting network for 4 items
+    auto sort2 = [&items](const int &a, const int &b) {
+      if ((items[a] & k_prefix_mask) > (items[b] & k_prefix_mask))
+        std::swap(items[a], items[b]);
+    };
+    sort2(0, 1);
+    sort2(2, 3);
+    sort2(0, 2);
+    sort2(1, 3);
+    sort2(1, 2);
+
+    uint64_t bucket =
+        codes->Encode(items[0] & k_prefix_mask, items[1] & k_prefix_mask,
+                     items[2] & k_prefix_mask, items[3] & k_prefix_mask);
+    for (uint32_t j = 0; j < k_items_per_bucket; j++) {
+      bucket |= (uint64_t)(items[j] >> k_prefix_bits)
+                << (packeddetail::k_code_bits + j * k_suffix_bits);
+    }
+    StoreBucket(i, bucket);
+  }
+
+ public:
+  // PackedTable constructor takes bucket_count as a parameter and will create
+  // an empty array of buckets, aligned to a cache line or to alignment bytes
+  // if that is larger. Code 0 decodes to four zero prefixes, so an all-zero
+  // bucket is empty.
+  PackedTable(const size_t bucket_count, const size_t& alignment = 0)
+      : bucket_count(bucket_count), codes(&packeddetail::Codes()) {
+    size_in_bytes = (k_bits_per_bucket * bucket_count + 7) / 8;
+    const size_t bytes = size_in_bytes + k_padding_bytes;
+    data = Data(static_cast<uint8_t *>(
+                    AlignedAllocator<>::Allocate(bytes, alignment)),
+                AllocatorDeleter<AlignedAllocator<>>(bytes));
+  }
+
+  // PackedTable destructor
+  virtual ~PackedTable() = default;
+
+  // BucketCount returns number of bucket in a Table
+  size_t BucketCount() const { return bucket_count; }
+
+  // SizeTable returns total size of a Table (used and unused)
+  size_t SizeTable() const { return k_items_per_bucket * bucket_count; }
+
+  // SizeTable returns total size of a Table in bytes (used and unused)
+  size_t SizeInBytes() const { return size_in_bytes; }
+
+  // ReadItem returns the j-th fingerprint of bucket i in sorted order
+  uint32_t ReadItem(const uint32_t &i, const uint32_t &j) const {
+    uint32_t items[k_items_per_bucket];
+    ReadBucket(i, items);
+    return items[j];
+  }
+
+  // WriteItem replaces the j-th fingerprint of bucket i in sorted order
+  void WriteItem(const uint32_t &i, const uint32_t &j,
+                 const uint32_t &fingerprint) {
+    uint32_t items[k_items_per_bucket];
+    ReadBucket(i, items);
+    items[j] = fingerprint;
+    WriteBucket(i, items);
+  }
+
+  // Prefetch asks the CPU to load bucket i into the cache
+  void Prefetch(const uint32_t &i) const {
+    __builtin_prefetch(data.get() + (((size_t)i * k_bits_per_bucket) >> 3));
+  }
+
+  // GetBucket returns all items from bucket i
+  vector<uint32_t> GetBucket(const uint32_t &i) const {
+    uint32_t items[k_items_per_bucket];
+    vector<uint32_t> bucket;
+
+    ReadBucket(i, items);
+    for (uint32_t j = 0; j < k_items_per_bucket; j++)
+      if (items[j] != 0) bucket.push_back(items[j]);
+
+    return bucket;
+  }
+
+  // DeleteItemFromBucket deletes an item (fingerprint) from bucket i
+  bool DeleteItemFromBucket(const uint32_t &i, const uint32_t &fingerprint) {
+    uint32_t items[k_items_per_bucket];
+
+    ReadBucket(i, items);
+    for (uint32_t j = 0; j < k_items_per_bucket; j++) {
+      if (items[j] == fingerprint) {
+        items[j] = 0;
+        WriteBucket(i, items);
+
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  // FindFingerprintInBuckets returns a true if item is found in bucket i1 or
+  // i2, false otherwise
+  bool FindFingerprintInBuckets(const uint32_t &i1, const uint32_t &i2,
+                                const uint32_t &fingerprint) const {
+    return MatchBucket(LoadBucket(i1), fingerprint) ||
+           MatchBucket(LoadBucket(i2), fingerprint);
+  }
+
+  // InsertItemToBucket inserts an item (fingerprint) to a bucket i. If
+  // insertion was successful, returns true. If insertions was unsuccessful,
+  // returns false and if kickout is true will make a kickout of a random item
+  // from bucket i.
+  bool InsertItemToBucket(const uint32_t &i, const uint32_t &fingerprint,
+                          const bool &kickout, uint32_t &old_fingerprint) {
+    uint32_t items[k_items_per_bucket];
+
+    ReadBucket(i, items);
+    for (uint32_t j = 0; j < k_items_per_bucket; j++) {
+      if (items[j] == 0) {
+        items[j] = fingerprint;
+        WriteBucket(i, items);
+
+        return true;
+      }
+    }
+
+    if (kickout) {
+      uint32_t r = rand() % k_items_per_bucket;
+      old_fingerprint = items[r];
+      items[r] = fingerprint;
+      WriteBucket(i, items);
+    }
+
+    return false;
+  }
+
+  std::string Info() const {
+    std::stringstream ss;
+    ss << "PackedTable with fingerprint size: " << bits_per_item
        << " bits \n";
     ss << "\t\tItems per bucket: " << k_items_per_bucket << "\n";
+    ss << "\t\tBits per bucket: " << k_bits_per_bucket << "\n";
     ss << "\t\tTotal # of rows: " << bucket_count << "\n";
     ss << "\t\tTotal # slots: " << SizeTable() << "\n";
     return ss.str();
   }
 };
-}  // namespace cuckoofilterbio1
\ No newline at end of file
+}  // namespace cuckoofilterbio1
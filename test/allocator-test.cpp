@@ -0,0 +1,94 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "../src/table.h"
+
+using namespace cuckoofilterbio1;
+
+uint64_t NowNanos() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// testProbeLatency builds a Table of bucket_count buckets with allocator_type
+// and prints the time to construct it, to fill every bucket once (the first
+// touch of every page) and the average time of FindFingerprintInBuckets with
+// random buckets. In the dependent run every probe address depends on the
+// previous result, which measures latency; in the independent run probes can
+// overlap, which measures throughput.
+template <class allocator_type>
+void testProbeLatency(const char *name, const size_t bucket_count,
+                      const size_t probes) {
+  using table_type = Table<uint16_t, 4, allocator_type>;
+  uint64_t start_time = NowNanos();
+  std::unique_ptr<table_type> table =
+      std::make_unique<table_type>(bucket_count);
+  uint64_t construct_time = NowNanos() - start_time;
+
+  uint32_t old_fingerprint;
+  start_time = NowNanos();
+  for (size_t i = 0; i < bucket_count; i++)
+    table->InsertItemToBucket(i, (i * 2654435761u) | 1, false,
+                              old_fingerprint);
+  uint64_t fill_time = NowNanos() - start_time;
+
+  uint64_t x = 88172645463325252ULL;
+  size_t found_count = 0;
+  start_time = NowNanos();
+  for (size_t i = 0; i < probes; i++) {
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    bool found = table->FindFingerprintInBuckets(
+        x % bucket_count, (x >> 32) % bucket_count, x & 0xffff);
+    found_count += found;
+    // the next address depends on the result of this probe
+    x += found;
+  }
+  uint64_t dependent_time = NowNanos() - start_time;
+
+  start_time = NowNanos();
+  for (size_t i = 0; i < probes; i++) {
+    uint64_t h = (i + 1) * 0x9E3779B97F4A7C15ULL;
+    found_count += table->FindFingerprintInBuckets(
+        h % bucket_count, (h >> 32) % bucket_count, h & 0xffff);
+  }
+  uint64_t independent_time = NowNanos() - start_time;
+
+  std::cout << std::setw(24) << name << std::fixed << std::setprecision(1)
+            << std::setw(12) << construct_time / 1e6 << std::setw(12)
+            << fill_time / 1e6 << std::setprecision(2) << std::setw(14)
+            << (1. * dependent_time) / probes << std::setw(16)
+            << (1. * independent_time) / probes << "  (" << found_count
+            << ")" << std::endl;
+}
+
+int main(int argc, const char *argv[]) {
+  // 1 GiB of uint16_t buckets by default, far larger than the LLC
+  size_t table_mb = 1024;
+  if (argc > 1) table_mb = std::stoul(argv[1]);
+  const size_t bucket_count = (table_mb << 20) / (4 * sizeof(uint16_t));
+  const size_t probes = 20000000;
+
+  std::cout << "Table<uint16_t> of " << table_mb << " MB" << std::endl;
+  std::cout << std::setw(24) << "allocator" << std::setw(12) << "ctor ms"
+            << std::setw(12) << "fill ms" << std::setw(14) << "dependent ns"
+            << std::setw(16) << "independent ns" << std::endl;
+
+  testProbeLatency<AlignedAllocator<16>>("AlignedAllocator<16>", bucket_count,
+                                         probes);
+  testProbeLatency<AlignedAllocator<64>>("AlignedAllocator<64>", bucket_count,
+                                         probes);
+  testProbeLatency<MmapAllocator<false>>("MmapAllocator<false>", bucket_count,
+                                         probes);
+  testProbeLatency<MmapAllocator<true>>("MmapAllocator<true>", bucket_count,
+                                        probes);
+
+  return 0;
+}
@@ -0,0 +1,85 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "../src/cuckoofilter.h"
+
+using namespace cuckoofilterbio1;
+
+uint64_t NowNanos() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// testAssociativity fills a CF with table_type until Add fails and prints the
+// load factor reached, the average time of Add, of Contain for added items
+// (hits) and for other items (misses), and the false positive rate. Keys are
+// 64-bit integers so that hashing does not hide the cost of probing.
+template <class table_type>
+void testAssociativity(const char *name, const size_t max_items) {
+  using Filter = CuckooFilter<uint32_t, uint64_t, table_type>;
+  std::unique_ptr<Filter> cf = std::make_unique<Filter>(max_items);
+  const uint64_t negative_offset = 1ULL << 40;
+  const size_t lookups = 4 * max_items;
+
+  uint64_t added = 0;
+  uint64_t start_time = NowNanos();
+  while (cf->Add(added) == Ok) added++;
+  uint64_t add_time = NowNanos() - start_time;
+
+  size_t found_count = 0;
+  start_time = NowNanos();
+  for (size_t i = 0; i < lookups; i++)
+    found_count += cf->Contain((uint64_t)(i % added)) == Ok;
+  uint64_t hit_time = NowNanos() - start_time;
+
+  size_t false_positive_count = 0;
+  start_time = NowNanos();
+  for (size_t i = 0; i < lookups; i++)
+    false_positive_count += cf->Contain(negative_offset + i) == Ok;
+  uint64_t miss_time = NowNanos() - start_time;
+
+  std::cout << std::setw(24) << name << std::fixed << std::setprecision(4)
+            << std::setw(10) << cf->LoadFactor() << std::setprecision(2)
+            << std::setw(10) << (1. * add_time) / added << std::setw(10)
+            << (1. * hit_time) / lookups << std::setw(10)
+            << (1. * miss_time) / lookups << std::setprecision(4)
+            << std::setw(10) << (100. * false_positive_count) / lookups << "%"
+            << std::setw(10) << cf->BitsPerItem() << "  (" << found_count
+            << ")" << std::endl;
+}
+
+int main(int argc, const char *argv[]) {
+  std::srand(987654321);
+
+  size_t max_items = 1 << 22;
+  if (argc > 1) max_items = std::stoul(argv[1]);
+
+  std::cout << "max_items = " << max_items << std::endl;
+  std::cout << std::setw(24) << "table" << std::setw(10) << "load"
+            << std::setw(10) << "add ns" << std::setw(10) << "hit ns"
+            << std::setw(10) << "miss ns" << std::setw(11) << "FPP"
+            << std::setw(10) << "bits/item" << std::endl;
+
+  testAssociativity<Table<uint8_t, 2>>("Table<uint8_t, 2>", max_items);
+  testAssociativity<Table<uint8_t, 4>>("Table<uint8_t, 4>", max_items);
+  testAssociativity<Table<uint8_t, 8>>("Table<uint8_t, 8>", max_items);
+  testAssociativity<Table<uint8_t, 16>>("Table<uint8_t, 16>", max_items);
+  testAssociativity<Table<uint16_t, 2>>("Table<uint16_t, 2>", max_items);
+  testAssociativity<Table<uint16_t, 4>>("Table<uint16_t, 4>", max_items);
+  testAssociativity<Table<uint16_t, 8>>("Table<uint16_t, 8>", max_items);
+  testAssociativity<Table<uint16_t, 16>>("Table<uint16_t, 16>", max_items);
+  testAssociativity<BitPackedTable<12, 2>>("BitPackedTable<12, 2>",
+                                           max_items);
+  testAssociativity<BitPackedTable<12, 4>>("BitPackedTable<12, 4>",
+                                           max_items);
+  testAssociativity<BitPackedTable<12, 8>>("BitPackedTable<12, 8>",
+                                           max_items);
+
+  return 0;
+}
@@ -0,0 +1,140 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../src/dynamic-cuckoofilter.h"
+
+using namespace cuckoofilterbio1;
+
+uint64_t NowNanos() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// PrintResult prints average time per key and the number of keys found
+void PrintResult(const char *name, const uint64_t &total_time,
+                 const std::vector<Status> &out) {
+  size_t found_count = 0;
+  for (const Status &status : out) found_count += status == Ok;
+
+  std::cout << std::setw(36) << name << std::fixed << std::setprecision(2)
+            << std::setw(10) << (1. * total_time) / out.size() << " ns/key"
+            << "  (" << found_count << "/" << out.size() << ")" << std::endl;
+}
+
+// testContainBatch compares Contain one key at a time with ContainBatch on
+// a CF filled to 90%, for keys that are all in the CF and for keys that are
+// not
+template <class filter_type>
+void testContainBatch(const char *name, const size_t max_items) {
+  std::unique_ptr<filter_type> cf = std::make_unique<filter_type>(max_items);
+  for (uint64_t i = 0; i < 0.9 * max_items; i++) cf->Add(i);
+
+  const size_t lookups = 1 << 24;
+  std::vector<uint64_t> hits(lookups), misses(lookups);
+  for (size_t i = 0; i < lookups; i++) {
+    hits[i] = (i * 2654435761u) % (uint64_t)(0.9 * max_items);
+    misses[i] = (1ULL << 40) + i;
+  }
+  std::vector<Status> out(lookups);
+
+  std::cout << name << std::endl;
+  for (const std::vector<uint64_t> *keys : {&hits, &misses}) {
+    const char *kind = keys == &hits ? "hits" : "misses";
+
+    uint64_t start_time = NowNanos();
+    for (size_t i = 0; i < lookups; i++) out[i] = cf->Contain((*keys)[i]);
+    PrintResult((std::string("Contain ") + kind).c_str(),
+                NowNanos() - start_time, out);
+
+    start_time = NowNanos();
+    cf->ContainBatch(keys->data(), lookups, out.data());
+    PrintResult((std::string("ContainBatch ") + kind).c_str(),
+                NowNanos() - start_time, out);
+  }
+}
+
+// testContainsBatchDCF compares Contains with ContainsBatch on a DCF with
+// `levels` full CFs
+void testContainsBatchDCF(const size_t max_items, const size_t levels) {
+  using Filter = DynamicCuckooFilter<uint16_t, uint64_t>;
+  std::unique_ptr<Filter> dcf = std::make_unique<Filter>(max_items);
+  const uint64_t added = 0.9 * max_items * levels;
+  for (uint64_t i = 0; i < added; i++) dcf->Add(i);
+
+  const size_t lookups = 1 << 22;
+  std::vector<uint64_t> hits(lookups), misses(lookups);
+  for (size_t i = 0; i < lookups; i++) {
+    hits[i] = (i * 2654435761u) % added;
+    misses[i] = (1ULL << 40) + i;
+  }
+  std::vector<Status> out(lookups);
+
+  std::cout << "DynamicCuckooFilter<uint16_t> with " << max_items
+            << " items per CF, " << dcf->SizeOfEachCF().size() << " CFs"
+            << std::endl;
+  for (const std::vector<uint64_t> *keys : {&hits, &misses}) {
+    const char *kind = keys == &hits ? "hits" : "misses";
+
+    uint64_t start_time = NowNanos();
+    for (size_t i = 0; i < lookups; i++) out[i] = dcf->Contains((*keys)[i]);
+    PrintResult((std::string("Contains ") + kind).c_str(),
+                NowNanos() - start_time, out);
+
+    start_time = NowNanos();
+    dcf->ContainsBatch(keys->data(), lookups, out.data());
+    PrintResult((std::string("ContainsBatch ") + kind).c_str(),
+                NowNanos() - start_time, out);
+  }
+}
+
+// testAddBatch compares Add one key at a time with AddBatch, filling a CF
+// to 90% and a DCF with `levels` CFs of max_items / levels items
+template <class filter_type>
+void testAddBatch(const char *name, const size_t max_items,
+                  const size_t levels) {
+  const size_t count = 0.9 * max_items;
+  std::vector<uint64_t> keys(count);
+  for (size_t i = 0; i < count; i++) keys[i] = i * 0x9e3779b97f4a7c15ULL;
+  std::vector<Status> out(count);
+
+  std::cout << name << std::endl;
+  std::unique_ptr<filter_type> filter =
+      std::make_unique<filter_type>(max_items / levels);
+  uint64_t start_time = NowNanos();
+  for (size_t i = 0; i < count; i++) out[i] = filter->Add(keys[i]);
+  PrintResult("Add", NowNanos() - start_time, out);
+
+  filter = std::make_unique<filter_type>(max_items / levels);
+  start_time = NowNanos();
+  filter->AddBatch(keys.data(), count, out.data());
+  PrintResult("AddBatch", NowNanos() - start_time, out);
+}
+
+int main(int argc, const char *argv[]) {
+  size_t max_items = 1 << 27;
+  if (argc > 1) max_items = std::stoul(argv[1]);
+
+  testContainBatch<CuckooFilter<uint8_t, uint64_t>>(
+      "CuckooFilter<uint8_t>, in cache", 1 << 16);
+  testContainBatch<CuckooFilter<uint8_t, uint64_t>>("CuckooFilter<uint8_t>",
+                                                    max_items);
+  testContainBatch<CuckooFilter<uint16_t, uint64_t>>(
+      "CuckooFilter<uint16_t>", max_items);
+  testContainBatch<CuckooFilter<uint16_t, uint64_t,
+                                Table<uint16_t, 4, MmapAllocator<true>>>>(
+      "CuckooFilter<uint16_t>, huge pages", max_items);
+  testContainsBatchDCF(max_items / 16, 16);
+  testAddBatch<CuckooFilter<uint16_t, uint64_t>>("CuckooFilter<uint16_t>",
+                                                 max_items, 1);
+  testAddBatch<DynamicCuckooFilter<uint16_t, uint64_t>>(
+      "DynamicCuckooFilter<uint16_t>, 16 CFs", max_items, 16);
+
+  return 0;
+}
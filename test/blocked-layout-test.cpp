@@ -0,0 +1,103 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "../src/cuckoofilter.h"
+
+using namespace cuckoofilterbio1;
+
+uint64_t NowNanos() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// testLayout fills a CF with table_type and layout_type until Add fails and
+// prints the load factor reached, the average time of Add, of Contain for
+// added items (hits) and for other items (misses), the latency of a miss when
+// every key depends on the previous result, and the false positive rate
+template <class table_type, class layout_type>
+void testLayout(const char *name, const size_t max_items) {
+  using Filter =
+      CuckooFilter<uint32_t, uint64_t, table_type, Hash, layout_type>;
+  std::unique_ptr<Filter> cf = std::make_unique<Filter>(max_items);
+  const uint64_t negative_offset = 1ULL << 40;
+  const size_t lookups = max_items;
+
+  uint64_t added = 0;
+  uint64_t start_time = NowNanos();
+  while (cf->Add(added) == Ok) added++;
+  uint64_t add_time = NowNanos() - start_time;
+
+  size_t found_count = 0;
+  start_time = NowNanos();
+  for (size_t i = 0; i < lookups; i++)
+    found_count += cf->Contain((uint64_t)(i % added)) == Ok;
+  uint64_t hit_time = NowNanos() - start_time;
+
+  size_t false_positive_count = 0;
+  start_time = NowNanos();
+  for (size_t i = 0; i < lookups; i++)
+    false_positive_count += cf->Contain(negative_offset + i) == Ok;
+  uint64_t miss_time = NowNanos() - start_time;
+
+  uint64_t key = negative_offset;
+  start_time = NowNanos();
+  for (size_t i = 0; i < lookups; i++) key += 1 + cf->Contain(key);
+  uint64_t latency_time = NowNanos() - start_time;
+
+  std::cout << std::setw(40) << name << std::fixed << std::setprecision(4)
+            << std::setw(10) << cf->LoadFactor() << std::setprecision(2)
+            << std::setw(10) << (1. * add_time) / added << std::setw(10)
+            << (1. * hit_time) / lookups << std::setw(10)
+            << (1. * miss_time) / lookups << std::setw(10)
+            << (1. * latency_time) / lookups << std::setprecision(4)
+            << std::setw(10) << (100. * false_positive_count) / lookups << "%"
+            << "  (" << found_count << ", " << (key & 0xff) << ")"
+            << std::endl;
+}
+
+int main(int argc, const char *argv[]) {
+  std::srand(987654321);
+
+  size_t max_items = 1 << 27;
+  if (argc > 1) max_items = std::stoul(argv[1]);
+
+  std::cout << "max_items = " << max_items << std::endl;
+  std::cout << std::setw(40) << "table, layout" << std::setw(10) << "load"
+            << std::setw(10) << "add ns" << std::setw(10) << "hit ns"
+            << std::setw(10) << "miss ns" << std::setw(10) << "lat ns"
+            << std::setw(11) << "FPP"
+            << std::endl;
+
+  testLayout<Table<uint8_t>, FullRangeLayout>("Table<uint8_t>, FullRange",
+                                              max_items);
+  testLayout<Table<uint8_t>, BlockedLayout<64>>(
+      "Table<uint8_t>, Blocked<64>", max_items);
+  testLayout<Table<uint8_t>, BlockedLayout<4096>>(
+      "Table<uint8_t>, Blocked<4096>", max_items);
+  testLayout<Table<uint8_t, 8>, FullRangeLayout>(
+      "Table<uint8_t, 8>, FullRange", max_items);
+  testLayout<Table<uint8_t, 8>, BlockedLayout<64>>(
+      "Table<uint8_t, 8>, Blocked<64>", max_items);
+  // with huge pages a miss is mostly the cache miss, not the page walk
+  using HugeTable = Table<uint8_t, 4, MmapAllocator<true>>;
+  testLayout<HugeTable, FullRangeLayout>("huge Table<uint8_t>, FullRange",
+                                         max_items);
+  testLayout<HugeTable, BlockedLayout<64>>("huge Table<uint8_t>, Blocked<64>",
+                                           max_items);
+  testLayout<HugeTable, BlockedLayout<4096>>(
+      "huge Table<uint8_t>, Blocked<4096>", max_items);
+  testLayout<Table<uint16_t>, FullRangeLayout>("Table<uint16_t>, FullRange",
+                                               max_items);
+  testLayout<Table<uint16_t>, BlockedLayout<64>>(
+      "Table<uint16_t>, Blocked<64>", max_items);
+  testLayout<Table<uint16_t>, BlockedLayout<4096>>(
+      "Table<uint16_t>, Blocked<4096>", max_items);
+
+  return 0;
+}
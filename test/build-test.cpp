@@ -0,0 +1,64 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../src/dynamic-cuckoofilter.h"
+
+using namespace cuckoofilterbio1;
+
+uint64_t NowNanos() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// PrintResult prints average time per key and the number of keys stored
+void PrintResult(const char *name, const uint64_t &total_time,
+                 const size_t &count, const size_t &stored) {
+  std::cout << std::setw(36) << name << std::fixed << std::setprecision(2)
+            << std::setw(10) << (1. * total_time) / count << " ns/key"
+            << "  (" << stored << "/" << count << ")" << std::endl;
+}
+
+// testBuild compares a loop of Add with Build for count keys, on a CF or a
+// DCF made with max_items
+template <class filter_type>
+void testBuild(const char *name, const size_t max_items, const size_t count) {
+  std::vector<uint64_t> keys(count);
+  for (size_t i = 0; i < count; i++) keys[i] = i * 0x9e3779b97f4a7c15ULL;
+
+  std::cout << name << std::endl;
+  std::unique_ptr<filter_type> filter =
+      std::make_unique<filter_type>(max_items);
+  size_t stored = 0;
+  uint64_t start_time = NowNanos();
+  for (const uint64_t &key : keys) stored += filter->Add(key) == Ok;
+  PrintResult("Add", NowNanos() - start_time, count, stored);
+
+  filter = std::make_unique<filter_type>(max_items);
+  start_time = NowNanos();
+  stored = filter->Build(keys) == Ok ? count : 0;
+  PrintResult("Build", NowNanos() - start_time, count, stored);
+}
+
+int main(int argc, const char *argv[]) {
+  size_t max_items = 1 << 24;
+  if (argc > 1) max_items = std::stoul(argv[1]);
+
+  testBuild<CuckooFilter<uint16_t, uint64_t>>("CuckooFilter<uint16_t>, 90%",
+                                              max_items, 0.9 * max_items);
+  testBuild<CuckooFilter<uint16_t, uint64_t>>("CuckooFilter<uint16_t>, 95%",
+                                              max_items, 0.95 * max_items);
+  testBuild<CuckooFilter<uint16_t, uint64_t, PackedTable<13>>>(
+      "CuckooFilter<PackedTable<13>>, 90%", max_items, 0.9 * max_items);
+  testBuild<DynamicCuckooFilter<uint16_t, uint64_t>>(
+      "DynamicCuckooFilter<uint16_t>, 16 CFs", max_items / 16,
+      0.9 * max_items);
+
+  return 0;
+}
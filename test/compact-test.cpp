@@ -0,0 +1,128 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+
+#include "../src/dynamic-cuckoofilter.h"
+
+using namespace cuckoofilterbio1;
+
+using Filter = DynamicCuckooFilter<uint16_t, uint64_t>;
+
+uint64_t NowNanos() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// MakeFilter fills levels levels of items items each and deletes all but
+// one in four keys, so compaction can remove most levels
+std::unique_ptr<Filter> MakeFilter(const size_t items, const size_t levels) {
+  const size_t count = levels * items * 0.9;
+  std::unique_ptr<Filter> dcf = std::make_unique<Filter>(items);
+  for (uint64_t i = 0; i < count; i++) dcf->Add(i);
+  for (uint64_t i = 0; i < count; i++)
+    if (i % 4 != 0) dcf->Delete(i);
+  return dcf;
+}
+
+// PrintRow prints the results of one way of compacting: the number of
+// steps, the longest step (the longest pause of the lookups), the total
+// time of compacting and the average time of the lookups done meanwhile
+void PrintRow(const char *name, const size_t steps, const double max_pause,
+              const double total, const double lookup_time,
+              const size_t levels) {
+  std::cout << std::setw(14) << name << std::setw(8) << steps << std::fixed
+            << std::setprecision(3) << std::setw(12) << max_pause
+            << std::setw(12) << total << std::setprecision(2) << std::setw(10)
+            << lookup_time << std::setw(8) << levels << std::endl;
+}
+
+// testCompact compacts with one call of Compact
+void testCompact(const size_t items, const size_t levels) {
+  std::unique_ptr<Filter> dcf = MakeFilter(items, levels);
+  uint64_t start_time = NowNanos();
+  dcf->Compact();
+  double total = (NowNanos() - start_time) / 1e6;
+  PrintRow("Compact", 1, total, total, 0, dcf->SizeOfEachCF().size());
+}
+
+// testCompactStep compacts with CompactStep(budget) and does lookups
+// lookups between steps
+void testCompactStep(const size_t items, const size_t levels,
+                     const size_t budget, const size_t lookups) {
+  const size_t count = levels * items * 0.9;
+  std::unique_ptr<Filter> dcf = MakeFilter(items, levels);
+  size_t steps = 0, found = 0, done_lookups = 0;
+  uint64_t compact_time = 0, lookup_time = 0, max_pause = 0;
+
+  for (bool done = false; !done; steps++) {
+    uint64_t start_time = NowNanos();
+    done = dcf->CompactStep(budget);
+    uint64_t pause = NowNanos() - start_time;
+    compact_time += pause;
+    max_pause = std::max(max_pause, pause);
+
+    start_time = NowNanos();
+    for (size_t i = 0; i < lookups; i++, done_lookups++)
+      found += dcf->Contains(done_lookups * 2654435761u % count) == Ok;
+    lookup_time += NowNanos() - start_time;
+  }
+
+  std::string name = "step " + std::to_string(budget);
+  PrintRow(name.c_str(), steps, max_pause / 1e6, compact_time / 1e6,
+           1. * lookup_time / std::max<size_t>(done_lookups, 1),
+           dcf->SizeOfEachCF().size());
+  if (found == 0 && done_lookups > 0) std::cout << "no hits" << std::endl;
+}
+
+// testBackground compacts with a BackgroundCompaction while this thread
+// does lookups, each holding the mutex
+void testBackground(const size_t items, const size_t levels,
+                    const size_t budget) {
+  const size_t count = levels * items * 0.9;
+  std::unique_ptr<Filter> dcf = MakeFilter(items, levels);
+  std::mutex mutex;
+  size_t found = 0, lookups = 0;
+  uint64_t max_wait = 0;
+
+  uint64_t start_time = NowNanos();
+  {
+    BackgroundCompaction<Filter> compaction(*dcf, mutex, budget);
+    while (!compaction.Done()) {
+      uint64_t lookup_start = NowNanos();
+      std::lock_guard<std::mutex> lock(mutex);
+      found += dcf->Contains(lookups++ * 2654435761u % count) == Ok;
+      max_wait = std::max(max_wait, NowNanos() - lookup_start);
+    }
+  }
+  uint64_t total = NowNanos() - start_time;
+
+  std::string name = "background " + std::to_string(budget);
+  PrintRow(name.c_str(), 0, max_wait / 1e6, total / 1e6,
+           1. * total / std::max<size_t>(lookups, 1),
+           dcf->SizeOfEachCF().size());
+  if (found == 0 && lookups > 0) std::cout << "no hits" << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+  const size_t items = argc > 1 ? atoll(argv[1]) : 1 << 16;
+  const size_t levels = argc > 2 ? atoll(argv[2]) : 32;
+
+  std::cout << "levels before: " << levels << std::endl;
+  std::cout << std::setw(14) << "compaction" << std::setw(8) << "steps"
+            << std::setw(12) << "max ms" << std::setw(12) << "total ms"
+            << std::setw(10) << "lookup ns" << std::setw(8) << "after"
+            << std::endl;
+
+  testCompact(items, levels);
+  for (size_t budget : {64, 1024, 16384}) {
+    testCompactStep(items, levels, budget, 1024);
+  }
+  testBackground(items, levels, 1024);
+  return 0;
+}
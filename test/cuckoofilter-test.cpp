@@ -2,8 +2,11 @@
 
 #include <assert.h>
 
+#include <algorithm>
 #include <iostream>
 #include <memory>
+#include <string_view>
+#include <vector>
 
 #include "generators.h"
 using namespace cuckoofilterbio1;
@@ -50,10 +53,409 @@ void test_remove_item() {
   std::cout << "PASS test_remove_item" << std::endl;
 }
 
+// items added as std::string are found through a string_view into a larger
+// buffer or a (pointer, length) pair, and integers can be used as keys
+void test_heterogeneous_lookup() {
+  std::unique_ptr<CuckooFilter<uint16_t>> cf =
+      std::make_unique<CuckooFilter<uint16_t>>(100);
+
+  std::string genome = generateKMer(1000);
+  for (size_t pos = 0; pos < 50; pos++) {
+    assert(cf->Add(genome.substr(pos * 20, 20)) == Ok);
+  }
+
+  std::string_view view(genome);
+  for (size_t pos = 0; pos < 50; pos++) {
+    assert(cf->Contain(view.substr(pos * 20, 20)) == Ok);
+    assert(cf->Contain(genome.data() + pos * 20, 20) == Ok);
+  }
+
+  assert(cf->Delete(view.substr(0, 20)) == Ok);
+  assert(cf->Contain(genome.data(), 20) != Ok);
+
+  for (uint64_t key = 0; key < 40; key++) assert(cf->Add(key) == Ok);
+  for (uint64_t key = 0; key < 40; key++) assert(cf->Contain(key) == Ok);
+  assert(cf->Delete(uint64_t(7)) == Ok);
+  assert(cf->Contain(uint64_t(7)) != Ok);
+
+  std::cout << "PASS test_heterogeneous_lookup" << std::endl;
+}
+
+// a HashedItem computed by one CF can be used with another CF of the same size
+void test_hashed_item() {
+  CuckooFilter<uint16_t> cf1(100), cf2(100);
+  Hash hasher;
+  std::string s = generateKMer(20);
+
+  assert(cf1.Add(s) == Ok);
+  HashedItem hashed = cf2.GetHashedItem(hasher(s));
+  assert(cf1.ContainHashedItem(hashed) == Ok);
+  assert(cf2.ContainHashedItem(hashed) != Ok);
+  assert(cf1.DeleteHashedItem(hashed) == Ok);
+  assert(cf1.Contain(s) != Ok);
+
+  std::cout << "PASS test_hashed_item" << std::endl;
+}
+
+// the bucket count follows the slot count of table_type, and wider buckets
+// fill up further before Add fails
+template <size_t slots>
+void test_items_per_bucket_CF() {
+  using Filter = CuckooFilter<uint8_t, std::string, Table<uint8_t, slots>>;
+  std::unique_ptr<Filter> cf = std::make_unique<Filter>(1024);
+  std::vector<std::string> added;
+
+  assert(cf->GetBucketCount() == 1024 / slots);
+  while (true) {
+    std::string s = generateKMer(20);
+    if (cf->Add(s) != Ok) break;
+    added.push_back(s);
+  }
+  for (const std::string& s : added) assert(cf->Contain(s) == Ok);
+  assert(cf->LoadFactor() > (slots == 2 ? 0.7 : 0.9));
+
+  std::cout << "PASS test_items_per_bucket_CF<" << slots << ">" << std::endl;
+}
+
+// a CF with semi-sorted buckets finds everything it stores in fewer bytes
+void test_packed_table_CF() {
+  CuckooFilter<uint16_t, std::string, BitPackedTable<13>> plain(4096);
+  CuckooFilter<uint16_t, std::string, PackedTable<13>> packed(4096);
+  std::vector<std::string> added;
+
+  for (int i = 0; i < 3800; i++) {
+    std::string s = generateKMer(20);
+    assert(plain.Add(s) == Ok);
+    assert(packed.Add(s) == Ok);
+    added.push_back(s);
+  }
+  for (const std::string& s : added) assert(packed.Contain(s) == Ok);
+  assert(packed.SizeInBytes() < plain.SizeInBytes());
+  for (const std::string& s : added) assert(packed.Delete(s) == Ok);
+  assert(packed.Size() == 0);
+
+  std::cout << "PASS test_packed_table_CF" << std::endl;
+}
+
+// deleting from a full CF moves the victim back into the table without
+// counting it twice
+void test_delete_reinserts_victim() {
+  CuckooFilter<uint32_t> cf(1 << 20);
+  std::vector<uint32_t> added;
+
+  for (uint32_t i = 0; cf.Add(i) == Ok; i++) added.push_back(i);
+  assert(cf.Size() == added.size());
+  for (const uint32_t& i : added) assert(cf.Delete(i) == Ok);
+  assert(cf.Size() == 0);
+
+  std::cout << "PASS test_delete_reinserts_victim" << std::endl;
+}
+
+// with BlockedLayout both buckets of an item are different buckets of the
+// same block, and the filter still finds everything it stores
+template <size_t block_bytes>
+void test_blocked_layout() {
+  using Filter = CuckooFilter<uint16_t, std::string, Table<uint16_t>, Hash,
+                              BlockedLayout<block_bytes>>;
+  const size_t buckets_per_block = block_bytes / 8;
+  std::unique_ptr<Filter> cf = std::make_unique<Filter>(1 << 14);
+  // the layout of cf: buckets of 4 slots of 16 bits
+  const BlockedLayout<block_bytes> layout(4 * 16, cf->GetBucketCount());
+  const uint32_t index_mask = cf->GetBucketCount() - 1;
+  assert(layout.BucketsPerBlock() == buckets_per_block);
+  std::vector<std::string> added;
+
+  for (uint64_t hash = 1; hash < 100000; hash += 7919) {
+    HashedItem hashed = cf->GetHashedItem(hash * 0x9E3779B97F4A7C15ULL);
+    assert(hashed.index1 != hashed.index2);
+    assert(hashed.index1 / buckets_per_block ==
+           hashed.index2 / buckets_per_block);
+    assert(layout.AltIndex(hashed.index1, hashed.fingerprint, index_mask) ==
+           hashed.index2);
+    assert(layout.AltIndex(hashed.index2, hashed.fingerprint, index_mask) ==
+           hashed.index1);
+  }
+
+  while (true) {
+    std::string s = generateKMer(20);
+    if (cf->Add(s) != Ok) break;
+    added.push_back(s);
+  }
+  // 8 buckets of a 64-byte block fill up much earlier than 512 buckets of a
+  // page
+  assert(cf->LoadFactor() > (block_bytes == 64 ? 0.45 : 0.9));
+  for (const std::string& s : added) assert(cf->Contain(s) == Ok);
+  for (const std::string& s : added) assert(cf->Delete(s) == Ok);
+  assert(cf->Size() == 0);
+
+  // a filter with a single bucket has no other bucket in its block
+  Filter tiny(2);
+  assert(tiny.Add("ACGT") == Ok);
+  assert(tiny.Contain("ACGT") == Ok);
+
+  std::cout << "PASS test_blocked_layout<" << block_bytes << ">" << std::endl;
+}
+
+// Build adds a whole key set like Add does and reports keys that did not fit
+void test_build() {
+  CuckooFilter<uint16_t> cf(4096);
+  std::vector<std::string> keys;
+  for (int i = 0; i < 3900; i++) keys.push_back(generateKMer(20));
+
+  assert(cf.Build(keys) == Ok);
+  assert(cf.Size() == keys.size());
+  for (const std::string& key : keys) assert(cf.Contain(key) == Ok);
+
+  std::vector<std::string_view> more;
+  for (int i = 0; i < 500; i++) more.push_back(keys.back());
+  assert(cf.Build(more) == NotEnoughSpace);
+  assert(cf.Size() <= 4096);
+  for (const std::string& key : keys) assert(cf.Contain(key) == Ok);
+
+  CuckooFilter<uint16_t> empty(1024);
+  assert(empty.Build(std::vector<std::string>()) == Ok);
+  assert(empty.Size() == 0);
+
+  std::cout << "PASS test_build" << std::endl;
+}
+
+// Build with several threads fills disjoint parts of the table at once and
+// gives the same filter contents as a single thread
+template <class table_type>
+void test_parallel_build() {
+  using Filter = CuckooFilter<uint16_t, uint64_t, table_type>;
+  const size_t max_items = 1 << 20;
+  std::vector<uint64_t> keys(0.95 * max_items);
+  for (size_t i = 0; i < keys.size(); i++) keys[i] = i * 0x9E3779B97F4A7C15ULL;
+
+  std::unique_ptr<Filter> cf = std::make_unique<Filter>(max_items);
+  assert(cf->Build(keys, 4) == Ok);
+  assert(cf->Size() == keys.size());
+  for (const uint64_t& key : keys) assert(cf->Contain(key) == Ok);
+
+  // more keys than fit
+  std::vector<uint64_t> more(0.1 * max_items);
+  for (size_t i = 0; i < more.size(); i++) more[i] = ~keys[i];
+  assert(cf->Build(more, 3) == NotEnoughSpace);
+  assert(cf->Size() <= max_items);
+  for (const uint64_t& key : keys) assert(cf->Contain(key) == Ok);
+  for (const uint64_t& key : keys) assert(cf->Delete(key) == Ok);
+
+  std::cout << "PASS test_parallel_build" << std::endl;
+}
+
+// Expand doubles a CF in place and keeps every item it stores
+template <class table_type>
+void test_expand() {
+  CuckooFilter<uint16_t, std::string, table_type> cf(1024, 3);
+  std::vector<std::string> added;
+
+  for (int round = 0; round < 4; round++) {
+    while (cf.LoadFactor() < 0.9) {
+      added.push_back(generateKMer(20));
+      assert(cf.Add(added.back()) == Ok);
+    }
+    for (const std::string& s : added) assert(cf.Contain(s) == Ok);
+    if (round < 3) {
+      const size_t buckets = cf.GetBucketCount();
+      assert(cf.Expand() == Ok);
+      assert(cf.GetBucketCount() == 2 * buckets);
+      assert(cf.Size() == added.size());
+    }
+  }
+  assert(cf.Expansions() == 3);
+  assert(cf.Expand() == NotEnoughSpace);
+
+  // a victim is put back after expanding
+  while (!cf.HasVictim()) {
+    added.push_back(generateKMer(20));
+    assert(cf.Add(added.back()) == Ok);
+  }
+  CuckooFilter<uint16_t, std::string, table_type> full(1024, 1);
+  while (!full.HasVictim()) assert(full.Add(generateKMer(20)) == Ok);
+  const size_t full_size = full.Size();
+  assert(full.Expand() == Ok);
+  assert(!full.HasVictim() && full.Size() == full_size);
+
+  for (const std::string& s : added) assert(cf.Delete(s) == Ok);
+  assert(cf.Size() == 0);
+
+  // without max_expansions a CF cannot expand
+  CuckooFilter<uint16_t, std::string, table_type> fixed(1024);
+  assert(fixed.Expand() == NotEnoughSpace);
+
+  std::cout << "PASS test_expand" << std::endl;
+}
+
+// a CF keeps adding until its stash is full, finds stashed items and puts
+// them back into the table when a delete makes room
+void test_stash() {
+  CuckooFilter<uint8_t, std::string, Table<uint8_t, 2>> single(1024, 0, 1);
+  CuckooFilter<uint8_t, std::string, Table<uint8_t, 2>> stashed(1024, 0, 16);
+  std::vector<std::string> added;
+
+  while (single.Add(generateKMer(20)) == Ok) continue;
+  assert(single.StashSize() == 1 && single.IsFull());
+
+  while (true) {
+    std::string s = generateKMer(20);
+    if (stashed.Add(s) != Ok) break;
+    added.push_back(s);
+  }
+  assert(stashed.StashSize() == 16 && stashed.IsFull());
+  assert(stashed.Size() == added.size());
+  assert(stashed.LoadFactor() > single.LoadFactor());
+  for (const std::string& s : added) assert(stashed.Contain(s) == Ok);
+
+  // deleting from the table moves a stashed item back into it
+  assert(stashed.Delete(added[0]) == Ok);
+  assert(!stashed.IsFull());
+  for (size_t i = 1; i < added.size(); i++)
+    assert(stashed.Contain(added[i]) == Ok);
+
+  for (size_t i = 1; i < added.size(); i++)
+    assert(stashed.Delete(added[i]) == Ok);
+  assert(stashed.Size() == 0 && !stashed.HasVictim());
+
+  std::cout << "PASS test_stash" << std::endl;
+}
+
+// a CF that keeps fewer fingerprint bits finds every item and has the FPP
+// of the narrower fingerprint
+void test_fingerprint_bits() {
+  CuckooFilter<uint16_t, uint64_t> narrow(1 << 14, 0, default_stash_size, 8);
+  CuckooFilter<uint16_t, uint64_t> full(1 << 14);
+  assert(narrow.FingerprintBits() == 8 && full.FingerprintBits() == 16);
+  assert(narrow.SizeInBytes() == full.SizeInBytes());
+
+  for (uint64_t i = 0; i < 15000; i++) {
+    assert(Ok == narrow.Add(i));
+    assert(Ok == full.Add(i));
+  }
+  size_t narrow_fp = 0, full_fp = 0;
+  for (uint64_t i = 0; i < 15000; i++) assert(Ok == narrow.Contain(i));
+  for (uint64_t i = 1 << 20; i < (1 << 20) + 100000; i++) {
+    narrow_fp += narrow.Contain(i) == Ok;
+    full_fp += full.Contain(i) == Ok;
+  }
+  // 8 slots are probed, so about 8 / 2^8 and 8 / 2^16
+  assert(narrow_fp > 1500 && narrow_fp < 4500 && full_fp < 100);
+  for (uint64_t i = 0; i < 15000; i++) assert(Ok == narrow.Delete(i));
+  assert(narrow.Size() == 0);
+
+  std::cout << "PASS test_fingerprint_bits" << std::endl;
+}
+
+// BreadthFirstEviction keeps every item findable, moves fewer items than the
+// random walk to reach the same load and fills the table as far
+template <class table_type>
+void test_breadth_first_eviction() {
+  using Filter = CuckooFilter<uint16_t, std::string, table_type, Hash,
+                              FullRangeLayout, BreadthFirstEviction<>>;
+  std::unique_ptr<Filter> bfs = std::make_unique<Filter>(1 << 12);
+  CuckooFilter<uint16_t, std::string, table_type> walk(1 << 12);
+  std::vector<std::string> added;
+
+  while (bfs->LoadFactor() < 0.9) {
+    std::string s = generateKMer(20);
+    assert(bfs->Add(s) == Ok);
+    assert(walk.Add(s) == Ok);
+    added.push_back(s);
+  }
+  assert(!bfs->HasVictim());
+  assert(bfs->Kicks() > 0 && bfs->Kicks() < walk.Kicks());
+
+  while (true) {
+    std::string s = generateKMer(20);
+    if (bfs->Add(s) != Ok) break;
+    added.push_back(s);
+  }
+  assert(bfs->LoadFactor() > 0.95);
+  for (const std::string& s : added) assert(bfs->Contain(s) == Ok);
+  for (const std::string& s : added) assert(bfs->Delete(s) == Ok);
+  assert(bfs->Size() == 0);
+
+  std::cout << "PASS test_breadth_first_eviction" << std::endl;
+}
+
+// ContainBatch gives the same results as Contain for every key
+void test_contain_batch() {
+  CuckooFilter<uint16_t> cf(4096);
+  std::vector<std::string> keys;
+
+  for (int i = 0; i < 1003; i++) {
+    keys.push_back(generateKMer(20));
+    if (i % 3 != 0) assert(cf.Add(keys.back()) == Ok);
+  }
+  std::vector<std::string_view> views(keys.begin(), keys.end());
+
+  std::vector<Status> out(keys.size(), NotEnoughSpace);
+  cf.ContainBatch(keys.data(), keys.size(), out.data());
+  for (size_t i = 0; i < keys.size(); i++) {
+    assert(out[i] == cf.Contain(keys[i]));
+    if (i % 3 != 0) assert(out[i] == Ok);
+  }
+
+  std::vector<Status> view_out(views.size(), NotEnoughSpace);
+  cf.ContainBatch(views.data(), views.size(), view_out.data());
+  assert(view_out == out);
+
+  cf.ContainBatch(keys.data(), 0, out.data());
+
+  std::cout << "PASS test_contain_batch" << std::endl;
+}
+
+// AddBatch adds every key like Add and stops with NotEnoughSpace once the CF
+// is full
+void test_add_batch() {
+  CuckooFilter<uint16_t> cf(1024);
+  std::vector<std::string> keys;
+  for (int i = 0; i < 1500; i++) keys.push_back(generateKMer(20));
+
+  std::vector<Status> out(keys.size(), NotFound);
+  cf.AddBatch(keys.data(), 900, out.data());
+  assert(cf.Size() == 900);
+  for (size_t i = 0; i < 900; i++) {
+    assert(out[i] == Ok);
+    assert(cf.Contain(keys[i]) == Ok);
+  }
+
+  cf.AddBatch(keys.data() + 900, keys.size() - 900, out.data() + 900);
+  size_t added = std::count(out.begin(), out.end(), Ok);
+  assert(added == cf.Size() && added < keys.size());
+  assert(out.back() == NotEnoughSpace);
+  for (size_t i = 0; i < keys.size(); i++)
+    if (out[i] == Ok) assert(cf.Contain(keys[i]) == Ok);
+
+  std::cout << "PASS test_add_batch" << std::endl;
+}
+
 int main(int argc, const char* argv[]) {
   test_max_item();
   test_added_item_in_filter();
   test_remove_item();
+  test_heterogeneous_lookup();
+  test_hashed_item();
+  test_items_per_bucket_CF<2>();
+  test_items_per_bucket_CF<4>();
+  test_items_per_bucket_CF<8>();
+  test_items_per_bucket_CF<16>();
+  test_packed_table_CF();
+  test_delete_reinserts_victim();
+  test_blocked_layout<64>();
+  test_blocked_layout<4096>();
+  test_contain_batch();
+  test_add_batch();
+  test_build();
+  test_parallel_build<Table<uint16_t>>();
+  test_parallel_build<BitPackedTable<12>>();
+  test_parallel_build<PackedTable<13>>();
+  test_expand<Table<uint16_t>>();
+  test_expand<PackedTable<13>>();
+  test_stash();
+  test_fingerprint_bits();
+  test_breadth_first_eviction<Table<uint16_t>>();
+  test_breadth_first_eviction<PackedTable<13>>();
 
   return 0;
 }
@@ -5,6 +5,7 @@
 #include <algorithm>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -92,11 +93,419 @@ void test_compact_DCF() {
   std::cout << "PASS test_compact_DCF" << std::endl;
 }
 
+// Compact moves items into the same bucket of fuller CFs, so every item
+// that was not deleted is still found, and empty CFs are removed
+void test_compact_keeps_items_DCF() {
+  DynamicCuckooFilter<uint16_t> dcf(256);
+  std::vector<std::string> added;
+  for (int i = 0; i < 3000; i++) {
+    added.push_back(generateKMer(30));
+    assert(Ok == dcf.Add(added.back()));
+  }
+  const size_t levels = dcf.SizeOfEachCF().size();
+  for (size_t i = 0; i < added.size(); i++)
+    if (i % 4 != 0) assert(Ok == dcf.Delete(added[i]));
+
+  assert(Ok == dcf.Compact());
+  assert(dcf.SizeOfEachCF().size() < levels);
+  assert(dcf.TotalSize() == (added.size() + 3) / 4);
+  for (size_t i = 0; i < added.size(); i += 4)
+    assert(Ok == dcf.Contains(added[i]));
+  assert(Ok == dcf.Add(generateKMer(30)));
+
+  std::cout << "PASS test_compact_keeps_items_DCF" << std::endl;
+}
+
+// the DCF can be used between the steps of an incremental compaction, and it
+// ends as compact as after Compact
+void test_compact_step_DCF() {
+  DynamicCuckooFilter<uint16_t, uint64_t> dcf(
+      256, 0.9, default_stash_size, LevelGrowth(), true),
+      reference(256);
+  for (uint64_t i = 0; i < 20000; i++) {
+    assert(Ok == dcf.Add(i));
+    assert(Ok == reference.Add(i));
+  }
+  for (uint64_t i = 0; i < 20000; i++) {
+    if (i % 4 != 0) {
+      assert(Ok == dcf.Delete(i));
+      assert(Ok == reference.Delete(i));
+    }
+  }
+  const size_t levels = dcf.SizeOfEachCF().size();
+  assert(Ok == reference.Compact());
+
+  // each step moves at most 8 buckets; keys are added and deleted in between
+  size_t steps = 0;
+  uint64_t next = 20000;
+  while (!dcf.CompactStep(8)) {
+    steps++;
+    assert(Ok == dcf.Add(next++));
+    if (steps % 2 == 0) assert(Ok == dcf.Delete(next - 2));
+    if (steps % 64 == 0) {
+      for (uint64_t i = 0; i < 20000; i += 4) assert(Ok == dcf.Contains(i));
+      for (uint64_t i = 20000; i < next; i++)
+        if (i % 2 == 1 || i == next - 1) assert(Ok == dcf.Contains(i));
+    }
+  }
+  assert(steps > levels * 256 / 4 / 8 / 2);
+  assert(dcf.SizeOfEachCF().size() < levels);
+  assert(dcf.SizeOfEachCF().size() <= reference.SizeOfEachCF().size() + 1);
+  for (uint64_t i = 0; i < 20000; i += 4) assert(Ok == dcf.Contains(i));
+  for (uint64_t i = 20000; i < next; i++)
+    if (i % 2 == 1 || i == next - 1) assert(Ok == dcf.Contains(i));
+
+  // a new compaction starts with the next step
+  assert(!dcf.CompactStep(1));
+  assert(Ok == dcf.Compact());
+
+  std::cout << "PASS test_compact_step_DCF" << std::endl;
+}
+
+// a BackgroundCompaction compacts the DCF while another thread uses it
+void test_background_compaction_DCF() {
+  using Filter = DynamicCuckooFilter<uint16_t, uint64_t>;
+  Filter dcf(256);
+  std::mutex mutex;
+  for (uint64_t i = 0; i < 20000; i++) assert(Ok == dcf.Add(i));
+  for (uint64_t i = 0; i < 20000; i++)
+    if (i % 4 != 0) assert(Ok == dcf.Delete(i));
+  const size_t levels = dcf.SizeOfEachCF().size();
+
+  {
+    BackgroundCompaction<Filter> compaction(dcf, mutex, 16);
+    for (uint64_t i = 0; !compaction.Done(); i = (i + 4) % 20000) {
+      std::lock_guard<std::mutex> lock(mutex);
+      assert(Ok == dcf.Contains(i));
+    }
+  }
+  assert(dcf.SizeOfEachCF().size() < levels);
+  for (uint64_t i = 0; i < 20000; i += 4) assert(Ok == dcf.Contains(i));
+
+  std::cout << "PASS test_background_compaction_DCF" << std::endl;
+}
+
+void test_heterogeneous_lookup_DCF() {
+  std::unique_ptr<DynamicCuckooFilter<uint16_t>> dcf =
+      std::make_unique<DynamicCuckooFilter<uint16_t>>(64);
+  std::string genome = generateKMer(5000);
+  std::string_view view(genome);
+
+  for (size_t pos = 0; pos < 200; pos++) {
+    assert(Ok == dcf->Add(view.substr(pos * 25, 25)));
+  }
+  for (size_t pos = 0; pos < 200; pos++) {
+    assert(Ok == dcf->Contains(genome.substr(pos * 25, 25)));
+    assert(Ok == dcf->Contains(genome.data() + pos * 25, 25));
+  }
+  for (size_t pos = 0; pos < 200; pos++) {
+    assert(Ok == dcf->Delete(genome.data() + pos * 25, 25));
+  }
+  assert(dcf->TotalSize() == 0);
+
+  std::cout << "PASS test_heterogeneous_lookup_DCF" << std::endl;
+}
+
+void test_blocked_layout_DCF() {
+  using BlockedDynamicCuckooFilter =
+      DynamicCuckooFilter<uint16_t, std::string, Table<uint16_t>, Hash,
+                          BlockedLayout<>>;
+  std::unique_ptr<BlockedDynamicCuckooFilter> dcf =
+      std::make_unique<BlockedDynamicCuckooFilter>(256);
+  std::vector<std::string> added;
+
+  for (int i = 0; i < 2000; i++) {
+    added.push_back(generateKMer(30));
+    assert(Ok == dcf->Add(added.back()));
+  }
+  for (const std::string &s : added) assert(Ok == dcf->Contains(s));
+  for (const std::string &s : added) assert(Ok == dcf->Delete(s));
+  assert(dcf->TotalSize() == 0);
+
+  std::cout << "PASS test_blocked_layout_DCF" << std::endl;
+}
+
+// Build fills the levels up to the threshold and keeps every key
+void test_build_DCF() {
+  DynamicCuckooFilter<uint16_t> dcf(512);
+  std::vector<std::string> keys;
+  for (int i = 0; i < 5000; i++) keys.push_back(generateKMer(30));
+
+  assert(Ok == dcf.Build(keys));
+  assert(dcf.TotalSize() == keys.size());
+  for (const std::string &key : keys) assert(Ok == dcf.Contains(key));
+
+  std::vector<size_t> sizes = dcf.SizeOfEachCF();
+  assert(sizes.size() <= 12);
+  for (size_t i = 0; i + 1 < sizes.size(); i++) assert(sizes[i] >= 0.9 * 512);
+
+  for (const std::string &key : keys) assert(Ok == dcf.Delete(key));
+  assert(dcf.TotalSize() == 0);
+
+  std::cout << "PASS test_build_DCF" << std::endl;
+}
+
+// Build with several threads keeps every key
+void test_parallel_build_DCF() {
+  DynamicCuckooFilter<uint16_t, uint64_t> dcf(1 << 18);
+  std::vector<uint64_t> keys(1 << 20);
+  for (size_t i = 0; i < keys.size(); i++) keys[i] = i * 0x9E3779B97F4A7C15ULL;
+
+  assert(Ok == dcf.Build(keys, 4));
+  assert(dcf.TotalSize() == keys.size());
+  for (const uint64_t &key : keys) assert(Ok == dcf.Contains(key));
+
+  std::cout << "PASS test_parallel_build_DCF" << std::endl;
+}
+
+// compacting on several threads keeps every item and the item counts, and
+// removes about as many CFs as compacting on one
+template <class filter_type>
+void test_parallel_compact() {
+  filter_type dcf(1 << 12), reference(1 << 12);
+  for (uint64_t i = 0; i < 100000; i++) {
+    assert(Ok == dcf.Add(i));
+    assert(Ok == reference.Add(i));
+  }
+  for (uint64_t i = 0; i < 100000; i++) {
+    if (i % 4 != 0) {
+      assert(Ok == dcf.Delete(i));
+      assert(Ok == reference.Delete(i));
+    }
+  }
+  const size_t levels = dcf.SizeOfEachCF().size();
+
+  assert(Ok == dcf.Compact(4));
+  assert(Ok == reference.Compact());
+  const std::vector<size_t> sizes = dcf.SizeOfEachCF();
+  assert(sizes.size() < levels);
+  assert(sizes.size() <= reference.SizeOfEachCF().size() + 1);
+  size_t total = 0;
+  for (const size_t &size : sizes) total += size;
+  assert(total == 25000 && dcf.TotalSize() == 25000);
+  for (uint64_t i = 0; i < 100000; i += 4) assert(Ok == dcf.Contains(i));
+  for (uint64_t i = 0; i < 100000; i += 4) assert(Ok == dcf.Delete(i));
+  assert(dcf.TotalSize() == 0);
+}
+
+void test_parallel_compact_DCF() {
+  test_parallel_compact<DynamicCuckooFilter<uint16_t, uint64_t>>();
+  test_parallel_compact<
+      DynamicCuckooFilter<uint16_t, uint64_t, BitPackedTable<12>>>();
+
+  std::cout << "PASS test_parallel_compact_DCF" << std::endl;
+}
+
+// with a load factor threshold of 1 a level is only left once its stash is
+// full, and a larger stash fills each level further
+void test_stash_DCF() {
+  DynamicCuckooFilter<uint8_t, std::string, Table<uint8_t, 2>> single(512, 1,
+                                                                      1);
+  DynamicCuckooFilter<uint8_t, std::string, Table<uint8_t, 2>> stashed(512, 1,
+                                                                       16);
+  std::vector<std::string> added;
+
+  for (int i = 0; i < 4000; i++) {
+    added.push_back(generateKMer(30));
+    assert(Ok == single.Add(added.back()));
+    assert(Ok == stashed.Add(added.back()));
+  }
+  assert(stashed.SizeOfEachCF().size() <= single.SizeOfEachCF().size());
+  assert(stashed.SizeOfEachCF()[0] > single.SizeOfEachCF()[0]);
+  for (const std::string &s : added) assert(Ok == stashed.Contains(s));
+  for (const std::string &s : added) assert(Ok == stashed.Delete(s));
+  assert(stashed.TotalSize() == 0);
+
+  std::cout << "PASS test_stash_DCF" << std::endl;
+}
+
+// the level summary keeps every item findable while items are deleted and
+// levels compacted, also with more levels than summary bits
+void test_summary_DCF() {
+  DynamicCuckooFilter<uint16_t> dcf(64, 0.9, default_stash_size,
+                                    LevelGrowth(), true);
+  DynamicCuckooFilter<uint16_t> plain(64);
+  std::vector<std::string> added;
+  for (int i = 0; i < 5000; i++) {
+    added.push_back(generateKMer(30));
+    assert(Ok == dcf.Add(added.back()));
+    assert(Ok == plain.Add(added.back()));
+  }
+  assert(dcf.SizeOfEachCF().size() > 64);
+  // the summary is only kept if asked for
+  assert(dcf.TotalSizeInBytes() > plain.TotalSizeInBytes());
+
+  for (size_t i = 0; i < added.size(); i++)
+    if (i % 3 != 0) assert(Ok == dcf.Delete(added[i]));
+  for (size_t i = 0; i < added.size(); i += 3)
+    assert(Ok == dcf.Contains(added[i]));
+
+  std::vector<Status> out(added.size(), NotFound);
+  dcf.ContainsBatch(added.data(), added.size(), out.data());
+  for (size_t i = 0; i < added.size(); i++)
+    assert(out[i] == dcf.Contains(added[i]));
+
+  assert(Ok == dcf.Compact());
+  for (size_t i = 0; i < added.size(); i += 3)
+    assert(Ok == dcf.Contains(added[i]));
+  for (size_t i = 0; i < added.size(); i += 3)
+    assert(Ok == dcf.Delete(added[i]));
+  assert(dcf.TotalSize() == 0);
+
+  std::cout << "PASS test_summary_DCF" << std::endl;
+}
+
+// with geometric growth the CFs get larger and keep more fingerprint bits,
+// so there are few levels and the FPP stays lower than without tightening
+void test_level_growth_DCF() {
+  using Filter = DynamicCuckooFilter<uint16_t, uint64_t>;
+  Filter tightening(256, 0.9, default_stash_size, LevelGrowth(2, 8, 1));
+  Filter fixed_width(256, 0.9, default_stash_size, LevelGrowth(2, 8, 0));
+  Filter uniform(256);
+  std::vector<uint64_t> keys(30000);
+  for (size_t i = 0; i < keys.size(); i++) keys[i] = i * 0x9E3779B97F4A7C15ULL;
+
+  std::vector<Status> out(keys.size(), NotFound);
+  tightening.AddBatch(keys.data(), keys.size(), out.data());
+  for (const Status &status : out) assert(status == Ok);
+  assert(Ok == fixed_width.Build(keys));
+  for (const uint64_t &key : keys) assert(Ok == uniform.Add(key));
+
+  std::vector<size_t> sizes = tightening.SizeOfEachCF();
+  assert(sizes.size() <= 8 && uniform.SizeOfEachCF().size() > 100);
+  for (size_t i = 0; i + 2 < sizes.size(); i++) assert(sizes[i + 1] > sizes[i]);
+  for (const uint64_t &key : keys) assert(Ok == tightening.Contains(key));
+  for (const uint64_t &key : keys) assert(Ok == fixed_width.Contains(key));
+
+  size_t tightening_fp = 0, fixed_width_fp = 0;
+  std::vector<uint64_t> others(100000);
+  for (size_t i = 0; i < others.size(); i++) others[i] = (1ULL << 40) + i;
+  out.resize(others.size());
+  tightening.ContainsBatch(others.data(), others.size(), out.data());
+  for (size_t i = 0; i < others.size(); i++) {
+    assert(out[i] == tightening.Contains(others[i]));
+    tightening_fp += out[i] == Ok;
+    fixed_width_fp += fixed_width.Contains(others[i]) == Ok;
+  }
+  assert(2 * tightening_fp < fixed_width_fp);
+
+  // a fingerprint that matches in one CF may belong to an item of another,
+  // so deleting and compacting are refused and no item is ever lost
+  for (size_t i = 0; i < keys.size(); i++)
+    assert(NotSupported == tightening.Delete(keys[i]));
+  assert(NotSupported == tightening.Compact());
+  assert(NotSupported == tightening.Compact(4));
+  assert(tightening.CompactStep(1));
+  assert(tightening.TotalSize() == keys.size());
+  assert(tightening.SizeOfEachCF() == sizes);
+  size_t lost = 0;
+  for (const uint64_t &key : keys) lost += Ok != tightening.Contains(key);
+  assert(lost == 0);
+
+  // a factor below 1 would shrink the CFs, so it is raised to 1
+  Filter shrinking(256, 0.9, default_stash_size, LevelGrowth(0.5));
+  for (const uint64_t &key : keys) assert(Ok == shrinking.Add(key));
+  assert(shrinking.SizeOfEachCF() == uniform.SizeOfEachCF());
+  assert(Ok == shrinking.Delete(keys[0]));
+
+  // a fingerprint_step without fingerprint_bits, or with fingerprint_bits
+  // that fill the slot, leaves every CF at the slot width
+  for (const LevelGrowth &growth :
+       {LevelGrowth(1, 0, 2), LevelGrowth(1, 16, 1)}) {
+    Filter full_width(256, 0.9, default_stash_size, growth);
+    for (const uint64_t &key : keys) assert(Ok == full_width.Add(key));
+    for (const uint64_t &key : keys) assert(Ok == full_width.Delete(key));
+    assert(full_width.TotalSize() == 0);
+    assert(Ok == full_width.Compact());
+  }
+
+  std::cout << "PASS test_level_growth_DCF" << std::endl;
+}
+
+// a DCF with BreadthFirstEviction finds and deletes everything it stores
+void test_breadth_first_eviction_DCF() {
+  DynamicCuckooFilter<uint16_t, std::string, Table<uint16_t>, Hash,
+                      FullRangeLayout, BreadthFirstEviction<>>
+      dcf(512);
+  std::vector<std::string> added;
+
+  for (int i = 0; i < 3000; i++) {
+    added.push_back(generateKMer(30));
+    assert(Ok == dcf.Add(added.back()));
+  }
+  assert(dcf.TotalKicks() > 0);
+  for (const std::string &s : added) assert(Ok == dcf.Contains(s));
+  for (const std::string &s : added) assert(Ok == dcf.Delete(s));
+  assert(dcf.TotalSize() == 0);
+
+  std::cout << "PASS test_breadth_first_eviction_DCF" << std::endl;
+}
+
+// ContainsBatch gives the same results as Contains for every key, over
+// several levels
+void test_contains_batch_DCF() {
+  DynamicCuckooFilter<uint16_t> dcf(128);
+  std::vector<std::string> keys;
+
+  for (int i = 0; i < 1003; i++) {
+    keys.push_back(generateKMer(20));
+    if (i % 3 != 0) assert(Ok == dcf.Add(keys.back()));
+  }
+
+  std::vector<Status> out(keys.size(), NotEnoughSpace);
+  dcf.ContainsBatch(keys.data(), keys.size(), out.data());
+  for (size_t i = 0; i < keys.size(); i++) {
+    assert(out[i] == dcf.Contains(keys[i]));
+    if (i % 3 != 0) assert(out[i] == Ok);
+  }
+
+  std::cout << "PASS test_contains_batch_DCF" << std::endl;
+}
+
+// AddBatch fills the levels like Add does
+void test_add_batch_DCF() {
+  DynamicCuckooFilter<uint16_t> batch(128), single(128);
+  std::vector<std::string> keys;
+  for (int i = 0; i < 2003; i++) keys.push_back(generateKMer(20));
+
+  std::vector<Status> out(keys.size(), NotFound);
+  batch.AddBatch(keys.data(), keys.size(), out.data());
+  for (const std::string &key : keys) assert(Ok == single.Add(key));
+
+  assert(std::count(out.begin(), out.end(), Ok) == (long)keys.size());
+  assert(batch.TotalSize() == keys.size());
+  for (const std::string &key : keys) assert(Ok == batch.Contains(key));
+
+  std::vector<size_t> batch_sizes = batch.SizeOfEachCF();
+  std::vector<size_t> single_sizes = single.SizeOfEachCF();
+  assert(batch_sizes.size() + 1 >= single_sizes.size() &&
+         batch_sizes.size() <= single_sizes.size() + 1);
+  // every level but the last is filled up to the threshold
+  for (size_t i = 0; i + 1 < batch_sizes.size(); i++)
+    assert(batch_sizes[i] >= 0.9 * 128);
+
+  std::cout << "PASS test_add_batch_DCF" << std::endl;
+}
+
 int main(int argc, const char *argv[]) {
   test_construct_DCF();
   test_add_DCF();
   test_delete_DCF();
   test_contains_DCF();
   test_compact_DCF();
+  test_compact_keeps_items_DCF();
+  test_compact_step_DCF();
+  test_background_compaction_DCF();
+  test_heterogeneous_lookup_DCF();
+  test_blocked_layout_DCF();
+  test_contains_batch_DCF();
+  test_add_batch_DCF();
+  test_breadth_first_eviction_DCF();
+  test_build_DCF();
+  test_parallel_build_DCF();
+  test_parallel_compact_DCF();
+  test_stash_DCF();
+  test_summary_DCF();
+  test_level_growth_DCF();
   return 0;
 }
\ No newline at end of file
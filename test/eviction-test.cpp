@@ -0,0 +1,104 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../src/dynamic-cuckoofilter.h"
+
+using namespace cuckoofilterbio1;
+
+uint64_t NowNanos() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// testEviction fills a CF with eviction_type until the first victim and
+// prints the load factor reached, kicks per insert, and the mean, p99 and
+// max latency of a single Add. Keys are 64-bit integers.
+template <class table_type, class eviction_type>
+void testEviction(const char *name, const size_t max_items) {
+  using Filter = CuckooFilter<uint16_t, uint64_t, table_type, Hash,
+                              FullRangeLayout, eviction_type>;
+  std::unique_ptr<Filter> cf = std::make_unique<Filter>(max_items);
+  std::vector<uint32_t> latencies;
+  latencies.reserve(max_items);
+
+  uint64_t added = 0;
+  while (!cf->HasVictim() && added < max_items) {
+    uint64_t start_time = NowNanos();
+    cf->Add(added++ * 0x9e3779b97f4a7c15ULL);
+    latencies.push_back(NowNanos() - start_time);
+  }
+
+  uint64_t total_time = 0;
+  for (const uint32_t &latency : latencies) total_time += latency;
+  std::sort(latencies.begin(), latencies.end());
+
+  std::cout << std::setw(32) << name << std::fixed << std::setprecision(4)
+            << std::setw(10) << cf->LoadFactor() << std::setprecision(3)
+            << std::setw(10) << (1. * cf->Kicks()) / added
+            << std::setprecision(1) << std::setw(10)
+            << (1. * total_time) / added << std::setw(10)
+            << latencies[latencies.size() * 99 / 100] << std::setw(10)
+            << latencies.back() << std::endl;
+}
+
+// testEvictionDCF adds count keys to a DCF with eviction_type and prints
+// the number of CFs it needed and kicks per insert
+template <class eviction_type>
+void testEvictionDCF(const char *name, const size_t max_items,
+                     const size_t count) {
+  using Filter = DynamicCuckooFilter<uint16_t, uint64_t, Table<uint16_t>,
+                                     Hash, FullRangeLayout, eviction_type>;
+  std::unique_ptr<Filter> dcf = std::make_unique<Filter>(max_items);
+
+  uint64_t start_time = NowNanos();
+  for (uint64_t i = 0; i < count; i++) dcf->Add(i * 0x9e3779b97f4a7c15ULL);
+  uint64_t add_time = NowNanos() - start_time;
+
+  std::cout << std::setw(32) << name << std::setw(10)
+            << dcf->SizeOfEachCF().size() << std::fixed
+            << std::setprecision(3) << std::setw(10)
+            << (1. * dcf->TotalKicks()) / count << std::setprecision(1)
+            << std::setw(10) << (1. * add_time) / count << std::endl;
+}
+
+int main(int argc, const char *argv[]) {
+  size_t max_items = 1 << 22;
+  if (argc > 1) max_items = std::stoul(argv[1]);
+
+  std::cout << "max_items = " << max_items << std::endl;
+  std::cout << std::setw(32) << "CF until first victim" << std::setw(10)
+            << "load" << std::setw(10) << "kicks" << std::setw(10)
+            << "add ns" << std::setw(10) << "p99 ns" << std::setw(10)
+            << "max ns" << std::endl;
+
+  testEviction<Table<uint16_t>, RandomWalkEviction<>>("Table, random walk",
+                                                      max_items);
+  testEviction<Table<uint16_t>, BreadthFirstEviction<>>(
+      "Table, breadth-first", max_items);
+  testEviction<Table<uint16_t, 2>, RandomWalkEviction<>>(
+      "Table<2 slots>, random walk", max_items);
+  testEviction<Table<uint16_t, 2>, BreadthFirstEviction<>>(
+      "Table<2 slots>, breadth-first", max_items);
+  testEviction<PackedTable<13>, RandomWalkEviction<>>(
+      "PackedTable<13>, random walk", max_items);
+  testEviction<PackedTable<13>, BreadthFirstEviction<>>(
+      "PackedTable<13>, breadth-first", max_items);
+
+  std::cout << std::setw(32) << "DCF with 0.9 * 16 CFs of items"
+            << std::setw(10) << "CFs" << std::setw(10) << "kicks"
+            << std::setw(10) << "add ns" << std::endl;
+  testEvictionDCF<RandomWalkEviction<>>("random walk", max_items / 16,
+                                        0.9 * max_items);
+  testEvictionDCF<BreadthFirstEviction<>>("breadth-first", max_items / 16,
+                                          0.9 * max_items);
+
+  return 0;
+}
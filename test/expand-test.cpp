@@ -0,0 +1,101 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "../src/dynamic-cuckoofilter.h"
+
+using namespace cuckoofilterbio1;
+
+uint64_t NowNanos() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// PrintResult prints average times of adding and of looking up added
+// (hits) and other (misses) keys, the false positive rate, the size and the
+// number of hits found
+void PrintResult(const char *name, const double &add_time,
+                 const double &hit_time, const double &miss_time,
+                 const double &fpp, const size_t &bytes, const size_t &found) {
+  std::cout << std::setw(28) << name << std::fixed << std::setprecision(2)
+            << std::setw(10) << add_time << std::setw(10) << hit_time
+            << std::setw(10) << miss_time << std::setprecision(4)
+            << std::setw(10) << 100 * fpp << "%" << std::setw(10)
+            << (bytes >> 20) << " MB  (" << found << ")" << std::endl;
+}
+
+// testGrowth adds count keys to a filter that starts with room for
+// count / 2^expansions keys, once by expanding a CuckooFilter whenever it
+// reaches 90% load and once by letting a DynamicCuckooFilter add CFs
+void testGrowth(const size_t count, const size_t expansions) {
+  const size_t initial_items = (count >> expansions) / 0.9;
+  const size_t lookups = 1 << 22;
+  const uint64_t negative_offset = 1ULL << 40;
+  uint64_t start_time;
+
+  using Filter = CuckooFilter<uint16_t, uint64_t>;
+  std::unique_ptr<Filter> cf =
+      std::make_unique<Filter>(initial_items, expansions);
+  start_time = NowNanos();
+  for (uint64_t i = 0; i < count; i++) {
+    if (cf->LoadFactor() >= 0.9) cf->Expand();
+    cf->Add(i);
+  }
+  double add_time = 1. * (NowNanos() - start_time) / count;
+
+  size_t found = 0, false_positives = 0;
+  start_time = NowNanos();
+  for (uint64_t i = 0; i < lookups; i++)
+    found += cf->Contain((i * 2654435761u) % count) == Ok;
+  double hit_time = 1. * (NowNanos() - start_time) / lookups;
+  start_time = NowNanos();
+  for (uint64_t i = 0; i < lookups; i++)
+    false_positives += cf->Contain(negative_offset + i) == Ok;
+  double miss_time = 1. * (NowNanos() - start_time) / lookups;
+  PrintResult("CF with Expand", add_time, hit_time, miss_time,
+              1. * false_positives / lookups, cf->SizeInBytes(), found);
+
+  using DynamicFilter = DynamicCuckooFilter<uint16_t, uint64_t>;
+  std::unique_ptr<DynamicFilter> dcf =
+      std::make_unique<DynamicFilter>(initial_items);
+  start_time = NowNanos();
+  for (uint64_t i = 0; i < count; i++) dcf->Add(i);
+  add_time = 1. * (NowNanos() - start_time) / count;
+
+  found = 0, false_positives = 0;
+  start_time = NowNanos();
+  for (uint64_t i = 0; i < lookups; i++)
+    found += dcf->Contains((i * 2654435761u) % count) == Ok;
+  hit_time = 1. * (NowNanos() - start_time) / lookups;
+  start_time = NowNanos();
+  for (uint64_t i = 0; i < lookups; i++)
+    false_positives += dcf->Contains(negative_offset + i) == Ok;
+  miss_time = 1. * (NowNanos() - start_time) / lookups;
+  PrintResult(("DCF with " + std::to_string(dcf->SizeOfEachCF().size()) +
+               " CFs")
+                  .c_str(),
+              add_time, hit_time, miss_time, 1. * false_positives / lookups,
+              dcf->TotalSizeInBytes(), found);
+}
+
+int main(int argc, const char *argv[]) {
+  size_t count = 1 << 24;
+  if (argc > 1) count = std::stoul(argv[1]);
+
+  std::cout << count << " keys, uint16_t fingerprints" << std::endl;
+  std::cout << std::setw(28) << "" << std::setw(10) << "add ns"
+            << std::setw(10) << "hit ns" << std::setw(10) << "miss ns"
+            << std::setw(11) << "FPP" << std::setw(13) << "size"
+            << std::endl;
+  for (size_t expansions = 1; expansions <= 4; expansions++) {
+    std::cout << "grown " << (1 << expansions) << "x" << std::endl;
+    testGrowth(count, expansions);
+  }
+
+  return 0;
+}
@@ -138,6 +138,58 @@ void testDynamicCuckooFilter32(std::set<std::string> &positive_set,
             << std::endl;
 }
 
+// testCuckooFilterBits uses BitPackedTable to test any fingerprint size
+template <size_t bits>
+void testCuckooFilterBits(std::set<std::string> &positive_set,
+                          std::set<std::string> &negative_set) {
+  using TypedCuckooFilter =
+      CuckooFilter<uint32_t, std::string, BitPackedTable<bits>>;
+  std::unique_ptr<TypedCuckooFilter> cf =
+      std::make_unique<TypedCuckooFilter>(positive_set.size());
+  std::cout << "CuckooFilter<BitPackedTable<" << bits << ">> ";
+  for (std::string item : positive_set) {
+    cf->Add(item);
+  }
+  size_t found_count = 0;
+
+  for (std::string item : negative_set) {
+    if (cf->Contain(item) == Ok) {
+      found_count++;
+    }
+  }
+
+  double false_positive_rate = (found_count * 1.) / negative_set.size() * 100;
+  std::cout << "False positive rate: (" << found_count << "/"
+            << negative_set.size() << ") " << false_positive_rate << "%"
+            << " bits/item: " << cf->BitsPerItem() << std::endl;
+}
+
+template <size_t bits>
+void testDynamicCuckooFilterBits(std::set<std::string> &positive_set,
+                                 std::set<std::string> &negative_set) {
+  using TypedDynamicCuckooFilter =
+      DynamicCuckooFilter<uint32_t, std::string, BitPackedTable<bits>>;
+  std::unique_ptr<TypedDynamicCuckooFilter> dcf =
+      std::make_unique<TypedDynamicCuckooFilter>(positive_set.size() / 4);
+  std::cout << "DynamicCuckooFilter<BitPackedTable<" << bits << ">> ";
+  for (std::string item : positive_set) {
+    dcf->Add(item);
+  }
+  size_t found_count = 0;
+
+  for (std::string item : negative_set) {
+    if (dcf->Contains(item) == Ok) {
+      found_count++;
+    }
+  }
+
+  double false_positive_rate = (found_count * 1.) / negative_set.size() * 100;
+  std::cout << "False positive rate: (" << found_count << "/"
+            << negative_set.size() << ") " << false_positive_rate << "%"
+            << " bits/item: "
+            << (8. * dcf->TotalSizeInBytes()) / dcf->TotalSize() << std::endl;
+}
+
 void test4(size_t N) {
   std::cerr << "Running: TEST4 - (random) - " << N << std::endl;
   std::cout << "TEST4 - (random) - " << N << std::endl;
@@ -172,6 +224,18 @@ void test4(size_t N) {
   testDynamicCuckooFilter8(positive_set, negative_set);
   testDynamicCuckooFilter16(positive_set, negative_set);
   testDynamicCuckooFilter32(positive_set, negative_set);
+
+  // sweep fingerprint sizes that are not a whole uint8_t/uint16_t/uint32_t
+  testCuckooFilterBits<4>(positive_set, negative_set);
+  testCuckooFilterBits<6>(positive_set, negative_set);
+  testCuckooFilterBits<10>(positive_set, negative_set);
+  testCuckooFilterBits<12>(positive_set, negative_set);
+  testCuckooFilterBits<14>(positive_set, negative_set);
+  testCuckooFilterBits<20>(positive_set, negative_set);
+  testCuckooFilterBits<24>(positive_set, negative_set);
+  testDynamicCuckooFilterBits<6>(positive_set, negative_set);
+  testDynamicCuckooFilterBits<12>(positive_set, negative_set);
+  testDynamicCuckooFilterBits<20>(positive_set, negative_set);
 }
 
 int main(int argc, const char *argv[]) {
@@ -0,0 +1,71 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+
+#include "../src/dynamic-cuckoofilter.h"
+
+using namespace cuckoofilterbio1;
+
+uint64_t NowNanos() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// testGrowth adds count keys to a DCF whose first CF holds items items and
+// that grows as growth says. Then it prints the number of CFs, the size in
+// bytes, the FPP and the average times of adding and of lookups that hit
+// and that miss
+void testGrowth(const char *name, const size_t items, const size_t count,
+                const LevelGrowth &growth) {
+  const size_t lookups = 1 << 20;
+  const uint64_t negative_offset = 1ULL << 40;
+  using Filter = DynamicCuckooFilter<uint16_t, uint64_t>;
+
+  std::unique_ptr<Filter> dcf =
+      std::make_unique<Filter>(items, 0.9, default_stash_size, growth);
+  uint64_t start_time = NowNanos();
+  for (uint64_t i = 0; i < count; i++) dcf->Add(i);
+  double add_time = 1. * (NowNanos() - start_time) / count;
+
+  size_t found = 0;
+  start_time = NowNanos();
+  for (uint64_t i = 0; i < lookups; i++)
+    found += dcf->Contains((i * 2654435761u) % count) == Ok;
+  double hit_time = 1. * (NowNanos() - start_time) / lookups;
+
+  size_t false_positives = 0;
+  start_time = NowNanos();
+  for (uint64_t i = 0; i < lookups; i++)
+    false_positives += dcf->Contains(negative_offset + i) == Ok;
+  double miss_time = 1. * (NowNanos() - start_time) / lookups;
+
+  std::cout << std::setw(16) << name << std::setw(8)
+            << dcf->SizeOfEachCF().size() << std::setw(12)
+            << dcf->TotalSizeInBytes() << std::setw(12) << std::scientific
+            << std::setprecision(2) << 1. * false_positives / lookups
+            << std::fixed << std::setw(10) << add_time << std::setw(10)
+            << hit_time << std::setw(10) << miss_time << "  (" << found << ")"
+            << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+  const size_t items = argc > 1 ? atoll(argv[1]) : 1 << 12;
+  const size_t count = argc > 2 ? atoll(argv[2]) : 1 << 22;
+
+  std::cout << std::setw(16) << "growth" << std::setw(8) << "levels"
+            << std::setw(12) << "bytes" << std::setw(12) << "fpp"
+            << std::setw(10) << "add ns" << std::setw(10) << "hit ns"
+            << std::setw(10) << "miss ns" << std::endl;
+
+  testGrowth("uniform 12", items, count, LevelGrowth(1, 12));
+  // a factor below 1 is raised to 1, so this matches uniform 12
+  testGrowth("x0.5 12", items, count, LevelGrowth(0.5, 12));
+  testGrowth("x2 12", items, count, LevelGrowth(2, 12));
+  testGrowth("x2 8+1", items, count, LevelGrowth(2, 8, 1));
+  testGrowth("x2 12+1", items, count, LevelGrowth(2, 12, 1));
+  return 0;
+}
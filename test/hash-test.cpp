@@ -3,25 +3,105 @@
 #include <assert.h>
 
 #include <iostream>
+#include <set>
 
-void test_different_string() {
+using namespace cuckoofilterbio1;
+
+template <typename hash_used>
+void test_different_string(const char* name) {
   std::string s1("ACATATGTCCGTATGTACATACCTACGGACGTACATACGA");
   std::string s2("TGGTACGGTCGTATGTGCTTGAGTAAGTACGTAAGTAACT");
-  cuckoofilterbio1::Hash hasher;
+  hash_used hasher;
   assert(hasher(s1) != hasher(s2));
-  std::cout << "PASS test_different_string" << std::endl;
+  std::cout << "PASS test_different_string<" << name << ">" << std::endl;
 }
 
-void test_same_string() {
+template <typename hash_used>
+void test_same_string(const char* name) {
   std::string s1("TCGATCTCTGTTCGGTATGCCACCAATTTCAAGGTAAACT");
   std::string s2("TCGATCTCTGTTCGGTATGCCACCAATTTCAAGGTAAACT");
-  cuckoofilterbio1::Hash hasher;
+  hash_used hasher;
   assert(hasher(s1) == hasher(s2));
-  std::cout << "PASS test_same_string" << std::endl;
+  std::cout << "PASS test_same_string<" << name << ">" << std::endl;
+}
+
+// every prefix of a string hashes differently and the hash does not depend on
+// the alignment of the data
+template <typename hash_used>
+void test_lengths_and_alignment(const char* name) {
+  std::string s(
+      "GATTACAGATTACAGATTACACCGTAGCTAGCTAGGCTAACGTTAGCATCGATCGGCTAGCTAGCAT"
+      "CGACTGACTAGCTAGCATCGATCGACTAGCATGCAGCTAGCATCGAGCATTA");
+  hash_used hasher;
+  std::set<uint64_t> seen;
+
+  for (size_t len = 0; len <= s.size(); len++) {
+    uint64_t h = hasher(s.substr(0, len));
+    assert(seen.insert(h).second);
+
+    char buf[256];
+    memcpy(buf + 3, s.data(), len);
+    assert(hash_used::HashBytes(buf + 3, len) == h);
+  }
+  std::cout << "PASS test_lengths_and_alignment<" << name << ">" << std::endl;
+}
+
+// flipping one input bit should flip about half of the output bits, in both
+// the low (index) and the high (fingerprint) half
+template <typename hash_used>
+void test_avalanche(const char* name) {
+  std::string s("ACGTTGCAACGTTGCAACGTTGCAACGTTGCAACGTTGCAACGTTGCAACGT");
+  hash_used hasher;
+  uint64_t h = hasher(s);
+  size_t low_flips = 0, high_flips = 0, trials = 0;
+
+  for (size_t i = 0; i < s.size(); i++) {
+    for (int bit = 0; bit < 8; bit++) {
+      std::string t = s;
+      t[i] ^= 1 << bit;
+      uint64_t d = h ^ hasher(t);
+      low_flips += __builtin_popcountll(d & 0xffffffffULL);
+      high_flips += __builtin_popcountll(d >> 32);
+      trials++;
+    }
+  }
+
+  double low = 1.0 * low_flips / trials, high = 1.0 * high_flips / trials;
+  assert(low > 14 && low < 18);
+  assert(high > 14 && high < 18);
+  std::cout << "PASS test_avalanche<" << name << ">" << std::endl;
+}
+
+// std::string, std::string_view and (pointer, length) hash the same
+template <typename hash_used>
+void test_heterogeneous_keys(const char* name) {
+  std::string s("GGCATTACGACTAGCATCAGCATCGACTACGACTAGCAGCAT");
+  std::string_view view(s);
+  hash_used hasher;
+
+  assert(hasher(s) == hasher(view));
+  assert(hasher(s) == hasher(s.data(), s.length()));
+  assert(hasher(s.substr(5, 20)) == hasher(view.substr(5, 20)));
+  assert(hasher(uint32_t(42)) == hasher(uint32_t(42)));
+  assert(hasher(uint64_t(42)) != hasher(uint64_t(43)));
+  std::cout << "PASS test_heterogeneous_keys<" << name << ">" << std::endl;
+}
+
+template <typename hash_used>
+void test_hash(const char* name) {
+  test_different_string<hash_used>(name);
+  test_same_string<hash_used>(name);
+  test_lengths_and_alignment<hash_used>(name);
+  test_avalanche<hash_used>(name);
+  test_heterogeneous_keys<hash_used>(name);
 }
 
 int main(int argc, const char* argv[]) {
-  test_different_string();
-  test_same_string();
+  test_hash<Hash>("Hash");
+  test_hash<WyHash>("WyHash");
+  test_hash<MurmurHash3>("MurmurHash3");
+  test_different_string<SuperFastHash>("SuperFastHash");
+  test_same_string<SuperFastHash>("SuperFastHash");
+  test_lengths_and_alignment<SuperFastHash>("SuperFastHash");
   return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,67 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../src/hash.h"
+#include "generators.h"
+
+using namespace cuckoofilterbio1;
+
+uint64_t NowNanos() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// testHashThroughput hashes every k-mer of kmers `rounds` times and prints the
+// average time per hash and the throughput in GB/s
+template <typename hash_used>
+void testHashThroughput(const char *name, const std::vector<std::string> &kmers,
+                        size_t rounds) {
+  hash_used hasher;
+  uint64_t sink = 0;
+  size_t bytes = 0;
+
+  uint64_t start_time = NowNanos();
+  for (size_t r = 0; r < rounds; r++) {
+    for (const std::string &kmer : kmers) {
+      sink += hasher(kmer);
+      bytes += kmer.size();
+    }
+  }
+  uint64_t total_time = NowNanos() - start_time;
+
+  double avg_time = (1. * total_time) / (rounds * kmers.size());
+
+  // sink is printed so the hashing can not be optimized away
+  std::cout << std::setw(16) << name << std::setw(10) << std::fixed
+            << std::setprecision(2) << avg_time << " ns/hash" << std::setw(10)
+            << (1. * bytes) / total_time << " GB/s"
+            << "  (" << (sink & 0xff) << ")" << std::endl;
+}
+
+int main(int argc, const char *argv[]) {
+  std::srand(987654321);
+
+  const size_t kmer_count = 4096;
+
+  for (const size_t k : {8, 16, 32, 50, 100, 200, 500, 1000}) {
+    std::vector<std::string> kmers;
+    for (size_t i = 0; i < kmer_count; i++) kmers.push_back(generateKMer(k));
+
+    // roughly the same number of bytes is hashed for every k
+    size_t rounds = 1 + (64 << 20) / (k * kmer_count);
+
+    std::cout << "k = " << k << std::endl;
+    testHashThroughput<SuperFastHash>("SuperFastHash", kmers, rounds);
+    testHashThroughput<MurmurHash3>("MurmurHash3", kmers, rounds);
+    testHashThroughput<WyHash>("WyHash", kmers, rounds);
+    std::cout << std::endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,88 @@
+#include "../src/interleaved-dynamic-cuckoofilter.h"
+
+#include <assert.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../src/dynamic-cuckoofilter.h"
+#include "generators.h"
+
+using namespace cuckoofilterbio1;
+
+// items stay findable while levels are added and the table is re-strided,
+// and deleting them all empties every level
+void test_add_contains_delete_IDCF() {
+  InterleavedDynamicCuckooFilter<uint16_t> dcf(512);
+  std::vector<std::string> added;
+
+  for (int i = 0; i < 5000; i++) {
+    added.push_back(generateKMer(30));
+    assert(Ok == dcf.Add(added.back()));
+  }
+  assert(dcf.SizeOfEachCF().size() >= 10 && dcf.Stride() == 16);
+  assert(dcf.TotalSize() == added.size());
+  for (const std::string &s : added) assert(Ok == dcf.Contains(s));
+
+  std::vector<Status> out(added.size(), NotFound);
+  dcf.ContainsBatch(added.data(), added.size(), out.data());
+  for (const Status &status : out) assert(status == Ok);
+
+  for (const std::string &s : added) assert(Ok == dcf.Delete(s));
+  assert(dcf.TotalSize() == 0);
+  for (const size_t &size : dcf.SizeOfEachCF()) assert(size == 0);
+
+  std::cout << "PASS test_add_contains_delete_IDCF" << std::endl;
+}
+
+// levels fill up to the threshold like the CFs of a DynamicCuckooFilter, and
+// the false positive rate is that of the same number of CFs
+void test_same_as_DCF() {
+  InterleavedDynamicCuckooFilter<uint8_t> interleaved(1024);
+  DynamicCuckooFilter<uint8_t> dcf(1024);
+
+  for (int i = 0; i < 8000; i++) {
+    std::string s = generateKMer(30);
+    interleaved.Add(s);
+    dcf.Add(s);
+  }
+  std::vector<size_t> sizes = interleaved.SizeOfEachCF();
+  assert(sizes.size() == dcf.SizeOfEachCF().size());
+  for (size_t i = 0; i + 1 < sizes.size(); i++) assert(sizes[i] >= 0.9 * 1024);
+
+  size_t interleaved_fp = 0, dcf_fp = 0;
+  for (int i = 0; i < 20000; i++) {
+    std::string s = generateKMer(31);
+    interleaved_fp += interleaved.Contains(s) == Ok;
+    dcf_fp += dcf.Contains(s) == Ok;
+  }
+  assert(interleaved_fp < 2 * dcf_fp + 100);
+  assert(dcf_fp < 2 * interleaved_fp + 100);
+
+  std::cout << "PASS test_same_as_DCF" << std::endl;
+}
+
+// with a load factor threshold of 1 the stashes of the levels fill up, and
+// stashed items are found and deleted
+void test_stash_IDCF() {
+  InterleavedDynamicCuckooFilter<uint8_t, std::string, 2> dcf(512, 1, 16);
+  std::vector<std::string> added;
+
+  for (int i = 0; i < 4000; i++) {
+    added.push_back(generateKMer(30));
+    assert(Ok == dcf.Add(added.back()));
+  }
+  for (const std::string &s : added) assert(Ok == dcf.Contains(s));
+  for (const std::string &s : added) assert(Ok == dcf.Delete(s));
+  assert(dcf.TotalSize() == 0);
+
+  std::cout << "PASS test_stash_IDCF" << std::endl;
+}
+
+int main(int argc, const char *argv[]) {
+  test_add_contains_delete_IDCF();
+  test_same_as_DCF();
+  test_stash_IDCF();
+  return 0;
+}
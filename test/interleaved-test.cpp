@@ -0,0 +1,66 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "../src/dynamic-cuckoofilter.h"
+#include "../src/interleaved-dynamic-cuckoofilter.h"
+
+using namespace cuckoofilterbio1;
+
+uint64_t NowNanos() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// testLookups fills filter with levels levels of items items each (up to
+// the load factor threshold), then prints the average time of lookups that
+// miss, one at a time and with ContainsBatch, and the number found
+template <class filter_type>
+void testLookups(const char *name, const size_t items, const size_t levels) {
+  const size_t count = levels * items * 0.9;
+  const size_t lookups = 1 << 21;
+  const uint64_t negative_offset = 1ULL << 40;
+
+  std::unique_ptr<filter_type> filter = std::make_unique<filter_type>(items);
+  for (uint64_t i = 0; i < count; i++) filter->Add(i);
+
+  std::vector<uint64_t> keys(lookups);
+  for (uint64_t i = 0; i < lookups; i++) keys[i] = negative_offset + i;
+
+  size_t found = 0;
+  uint64_t start_time = NowNanos();
+  for (const uint64_t &key : keys) found += filter->Contains(key) == Ok;
+  double miss_time = 1. * (NowNanos() - start_time) / lookups;
+
+  std::vector<Status> out(lookups);
+  start_time = NowNanos();
+  filter->ContainsBatch(keys.data(), lookups, out.data());
+  double batch_time = 1. * (NowNanos() - start_time) / lookups;
+  for (const Status &status : out) found += status == Ok;
+
+  std::cout << std::setw(14) << name << std::setw(8)
+            << filter->SizeOfEachCF().size() << std::fixed
+            << std::setprecision(2) << std::setw(12) << miss_time
+            << std::setw(12) << batch_time << "  (" << found << ")"
+            << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+  const size_t items = argc > 1 ? atoll(argv[1]) : 1 << 20;
+
+  std::cout << std::setw(14) << "filter" << std::setw(8) << "levels"
+            << std::setw(12) << "miss ns" << std::setw(12) << "batch ns"
+            << std::endl;
+  for (size_t levels : {1, 2, 4, 8, 16, 32}) {
+    testLookups<DynamicCuckooFilter<uint16_t, uint64_t>>("separate", items,
+                                                         levels);
+    testLookups<InterleavedDynamicCuckooFilter<uint16_t, uint64_t>>(
+        "interleaved", items, levels);
+  }
+  return 0;
+}
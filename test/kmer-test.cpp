@@ -12,6 +12,17 @@
 
 using namespace cuckoofilterbio1;
 
+// Single hash per operation (one 64-bit hash gives fingerprint and index1,
+// index2 is a multiply of the fingerprint instead of hashing std::to_string).
+// CuckooFilter<uint32_t>, g++ -O2, 4.6 Mbp random ACGT genome as ecoli1.txt,
+// avg. ns/item (before -> after):
+//
+//   N          CF add      CF find     DCF add     DCF find
+//   1024       668 -> 198  386 -> 156  393 -> 201  755 -> 317
+//   16384      707 -> 355  724 -> 227  611 -> 232  1071 -> 373
+//   131072     949 -> 566  819 -> 529  759 -> 555  1284 -> 799
+//   1048576    1381 -> 913 1105 -> 817 1172 -> 788 1686 -> 1183
+
 std::string bases = "ACGT";
 int k_options[4] = {50, 100, 200, 500};
 
@@ -32,7 +43,7 @@ void testCuckooFilter(std::set<std::string> &positive_set,
   uint64_t start_time = NowNanos();
 
   // insert all items from positive_set
-  for (std::string item : positive_set) {
+  for (const std::string &item : positive_set) {
     if (cf->Add(item) == NotEnoughSpace) {
       break;
     }
@@ -50,9 +61,11 @@ void testCuckooFilter(std::set<std::string> &positive_set,
 
   start_time = NowNanos();
 
-  for (std::string item : positive_set) {
-    if (cf->Contain(item) == NotFound) {
-      break;
+  // count hits so the lookups can not be optimized away
+  size_t contained_count = 0;
+  for (const std::string &item : positive_set) {
+    if (cf->Contain(item) == Ok) {
+      contained_count++;
     }
   }
 
@@ -62,6 +75,8 @@ void testCuckooFilter(std::set<std::string> &positive_set,
   std::cout << "Total time to find " << cf->Size()
             << " items: " << total_contain_time << "ns (avg. "
             << avg_contain_time << "ns/item)" << std::endl;
+  std::cout << "Found items: " << contained_count << " / "
+            << positive_set.size() << std::endl;
 
   uint64_t used_bytes = cf->SizeInBytes();
 
@@ -73,7 +88,7 @@ void testCuckooFilter(std::set<std::string> &positive_set,
 
   size_t found_count = 0;
 
-  for (std::string item : negative_set) {
+  for (const std::string &item : negative_set) {
     if (cf->Contain(item) == Ok) {
       found_count++;
     }
@@ -94,7 +109,7 @@ void testDynamicCuckooFilter(std::set<std::string> &positive_set,
   uint64_t start_time = NowNanos();
 
   // insert all items from positive_set
-  for (std::string item : positive_set) {
+  for (const std::string &item : positive_set) {
     if (dcf->Add(item) == NotEnoughSpace) {
       break;
     }
@@ -113,9 +128,11 @@ void testDynamicCuckooFilter(std::set<std::string> &positive_set,
 
   start_time = NowNanos();
 
-  for (std::string item : positive_set) {
-    if (dcf->Contains(item) == NotFound) {
-      break;
+  // count hits so the lookups can not be optimized away
+  size_t contained_count = 0;
+  for (const std::string &item : positive_set) {
+    if (dcf->Contains(item) == Ok) {
+      contained_count++;
     }
   }
 
@@ -125,6 +142,8 @@ void testDynamicCuckooFilter(std::set<std::string> &positive_set,
   std::cout << "Total time to find " << dcf->TotalSize()
             << " items: " << total_contain_time << "ns (avg. "
             << avg_contain_time << "ns/item)" << std::endl;
+  std::cout << "Found items: " << contained_count << " / "
+            << positive_set.size() << std::endl;
 
   uint64_t used_bytes = dcf->TotalSizeInBytes();
 
@@ -133,7 +152,7 @@ void testDynamicCuckooFilter(std::set<std::string> &positive_set,
   if (negative_set.size() > 0) {
     size_t found_count = 0;
 
-    for (std::string item : negative_set) {
+    for (const std::string &item : negative_set) {
       if (dcf->Contains(item) == Ok) {
         found_count++;
       }
@@ -147,7 +166,7 @@ void testDynamicCuckooFilter(std::set<std::string> &positive_set,
   }
 
   int counter = 0;
-  for (std::string item : positive_set) {
+  for (const std::string &item : positive_set) {
     if (counter++ % 2 == 0) {
       continue;
     }
@@ -322,6 +341,61 @@ void test3(size_t N) {
   std::cout << std::endl;
 }
 
+// test4 indexes every k-mer of the genome, once with substr + Add and once with
+// the rolling InsertSequence
+void test4(size_t k) {
+  std::cerr << "Running: TEST4 - (all kmers of e.coli genome) - k: " << k
+            << std::endl;
+  std::cout << "TEST4 - (all kmers of e.coli genome) - k: " << k << std::endl;
+
+  std::ifstream ecoli1("ecoli1.txt");
+  std::string genom;
+
+  if (!ecoli1.is_open() || !getline(ecoli1, genom) || genom.size() < k) {
+    std::cout << "File failed to open or does not contain any data"
+              << std::endl;
+    return;
+  }
+  ecoli1.close();
+
+  size_t kmer_count = genom.size() - k + 1;
+
+  std::unique_ptr<CuckooFilter<uint32_t>> cf =
+      std::make_unique<CuckooFilter<uint32_t>>(kmer_count);
+
+  uint64_t start_time = NowNanos();
+  for (size_t pos = 0; pos < kmer_count; pos++) {
+    if (cf->Add(genom.substr(pos, k)) != Ok) break;
+  }
+  uint64_t substr_time = NowNanos() - start_time;
+
+  std::cout << "substr + Add: " << cf->Size() << " kmers in " << substr_time
+            << "ns (avg. " << substr_time / cf->Size() << "ns/kmer)"
+            << std::endl;
+
+  for (bool canonical : {false, true}) {
+    cf = std::make_unique<CuckooFilter<uint32_t>>(kmer_count);
+
+    start_time = NowNanos();
+    cf->InsertSequence(genom, k, canonical);
+    uint64_t insert_time = NowNanos() - start_time;
+
+    start_time = NowNanos();
+    std::vector<bool> found = cf->QuerySequence(genom, k, canonical);
+    uint64_t query_time = NowNanos() - start_time;
+
+    std::cout << "InsertSequence" << (canonical ? " (canonical): " : ": ")
+              << cf->Size() << " kmers in " << insert_time << "ns (avg. "
+              << insert_time / cf->Size() << "ns/kmer)" << std::endl;
+    std::cout << "QuerySequence" << (canonical ? " (canonical): " : ": ")
+              << std::count(found.begin(), found.end(), true) << " found in "
+              << query_time << "ns (avg. " << query_time / found.size()
+              << "ns/kmer)" << std::endl;
+  }
+
+  std::cout << std::endl;
+}
+
 int main(int argc, const char *argv[]) {
   std::srand(987654321);
 
@@ -331,5 +405,7 @@ int main(int argc, const char *argv[]) {
 
   // for (const size_t N : {10, 20, 50}) test3(N);
 
+  for (const size_t k : {50, 200}) test4(k);
+
   return 0;
 }
\ No newline at end of file
@@ -0,0 +1,128 @@
+#include "../src/nthash.h"
+
+#include <assert.h>
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../src/dynamic-cuckoofilter.h"
+#include "generators.h"
+
+using namespace cuckoofilterbio1;
+
+std::string ReverseComplement(const std::string &s) {
+  std::string rc(s.rbegin(), s.rend());
+  for (char &c : rc) c = "TGCA"[EncodeBase(c)];
+  return rc;
+}
+
+// rolling hash must match hashing every k-mer from scratch
+void test_rolling_equals_direct() {
+  std::string seq = generateKMer(1000);
+
+  for (size_t k : {1, 5, 31, 32, 63, 64, 65, 100}) {
+    for (bool canonical : {false, true}) {
+      RollingKmerHash rolling(seq.data(), seq.size(), k, canonical);
+      size_t expected_pos = 0;
+
+      while (rolling.Next()) {
+        assert(rolling.Position() == expected_pos);
+        uint64_t direct =
+            canonical ? NtHash<true>()(seq.substr(expected_pos, k))
+                      : NtHash<false>()(seq.substr(expected_pos, k));
+        assert(rolling.Hash() == direct);
+        expected_pos++;
+      }
+      assert(expected_pos == seq.size() - k + 1);
+    }
+  }
+
+  std::cout << "PASS test_rolling_equals_direct" << std::endl;
+}
+
+void test_canonical() {
+  NtHash<true> canonical;
+  NtHash<false> forward;
+
+  for (int i = 0; i < 100; i++) {
+    std::string kmer = generateKMer(40);
+    std::string rc = ReverseComplement(kmer);
+    assert(canonical(kmer) == canonical(rc));
+    if (kmer != rc) assert(forward(kmer) != forward(rc));
+  }
+
+  std::cout << "PASS test_canonical" << std::endl;
+}
+
+// k-mers that contain N are skipped
+void test_invalid_bases() {
+  std::string seq = "ACGTACGTNACGTACGTACNNACGTA";
+  std::vector<size_t> positions;
+  RollingKmerHash rolling(seq.data(), seq.size(), 5);
+
+  while (rolling.Next()) {
+    assert(seq.substr(rolling.Position(), 5).find('N') == std::string::npos);
+    assert(rolling.Hash() == NtHash<>()(seq.substr(rolling.Position(), 5)));
+    positions.push_back(rolling.Position());
+  }
+
+  std::vector<size_t> expected{0, 1, 2, 3, 9, 10, 11, 12, 13, 14, 21};
+  assert(positions == expected);
+
+  RollingKmerHash too_long(seq.data(), seq.size(), seq.size() + 1);
+  assert(!too_long.Next());
+
+  std::cout << "PASS test_invalid_bases" << std::endl;
+}
+
+void test_insert_query_sequence_CF() {
+  std::string genome = generateKMer(5000);
+  std::string other = generateKMer(5000);
+  const size_t k = 31;
+
+  CuckooFilter<uint32_t, std::string, Table<uint32_t>, NtHash<true>> cf(8192);
+  assert(cf.InsertSequence(genome, k, true) == Ok);
+  assert(cf.Size() == genome.size() - k + 1);
+
+  std::vector<bool> found = cf.QuerySequence(genome, k, true);
+  assert(std::count(found.begin(), found.end(), true) == (long)found.size());
+
+  // the reverse complement strand is found in canonical mode
+  found = cf.QuerySequence(ReverseComplement(genome), k, true);
+  assert(std::count(found.begin(), found.end(), true) == (long)found.size());
+
+  found = cf.QuerySequence(other, k, true);
+  assert(std::count(found.begin(), found.end(), true) < 5);
+
+  // single k-mers can be queried with Contain through NtHash
+  assert(cf.Contain(genome.substr(100, k)) == Ok);
+
+  std::cout << "PASS test_insert_query_sequence_CF" << std::endl;
+}
+
+void test_insert_query_sequence_DCF() {
+  std::string genome = generateKMer(5000);
+  const size_t k = 50;
+
+  DynamicCuckooFilter<uint16_t> dcf(512);
+  assert(dcf.InsertSequence(genome, k) == Ok);
+  assert(dcf.TotalSize() == genome.size() - k + 1);
+
+  std::vector<bool> found = dcf.QuerySequence(genome, k);
+  assert(std::count(found.begin(), found.end(), true) == (long)found.size());
+
+  std::cout << "PASS test_insert_query_sequence_DCF" << std::endl;
+}
+
+int main(int argc, const char *argv[]) {
+  test_rolling_equals_direct();
+  test_canonical();
+  test_invalid_bases();
+  test_insert_query_sequence_CF();
+  test_insert_query_sequence_DCF();
+
+  return 0;
+}
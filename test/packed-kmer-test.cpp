@@ -0,0 +1,122 @@
+#include "../src/packed-kmer.h"
+
+#include <assert.h>
+
+#include <iostream>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "../src/dynamic-cuckoofilter.h"
+#include "generators.h"
+
+using namespace cuckoofilterbio1;
+
+void test_pack_unpack() {
+  for (size_t k : {0, 1, 15, 31, 32, 33, 64, 100}) {
+    std::string s = generateKMer(k);
+    PackedKmer<100> kmer(s);
+    assert(kmer.Length() == k);
+    assert(kmer.WordCount() == (k + 31) / 32);
+    assert(kmer.ToString() == s);
+  }
+
+  assert(PackedKmer<4>(std::string("acgt")).ToString() == "ACGT");
+  assert(sizeof(PackedKmer<128>) <= 128 / 4 + 8);
+
+  std::cout << "PASS test_pack_unpack" << std::endl;
+}
+
+void test_invalid_kmer() {
+  bool thrown = false;
+  try {
+    PackedKmer<32> kmer(std::string("ACGTN"));
+  } catch (const std::invalid_argument &) {
+    thrown = true;
+  }
+  assert(thrown);
+
+  thrown = false;
+  try {
+    PackedKmer<4> kmer(std::string("ACGTA"));
+  } catch (const std::invalid_argument &) {
+    thrown = true;
+  }
+  assert(thrown);
+
+  std::cout << "PASS test_invalid_kmer" << std::endl;
+}
+
+void test_compare_kmer() {
+  PackedKmer<64> a(std::string("ACGTACGT")), b(std::string("ACGTACGT"));
+  PackedKmer<64> c(std::string("ACGTACGA")), d(std::string("ACGTACG"));
+  assert(a == b);
+  assert(a != c);
+  assert(a != d);
+  assert(!(a < b) && !(b < a));
+  assert((a < c) != (c < a));
+
+  std::set<PackedKmer<64>> set{a, b, c, d};
+  assert(set.size() == 3);
+
+  std::cout << "PASS test_compare_kmer" << std::endl;
+}
+
+void test_hash_kmer() {
+  KmerHash hasher;
+  PackedKmer<64> a(std::string("ACGTACGTAC")), b(std::string("ACGTACGTAC"));
+  // "A" is encoded as 0, so a shorter k-mer must not collide with a longer one
+  PackedKmer<64> c(std::string("ACGTACGTACA"));
+  assert(hasher(a) == hasher(b));
+  assert(hasher(a) != hasher(c));
+
+  std::set<uint64_t> hashes;
+  for (int i = 0; i < 1000; i++)
+    hashes.insert(hasher(PackedKmer<64>(generateKMer(40))));
+  assert(hashes.size() == 1000);
+
+  std::cout << "PASS test_hash_kmer" << std::endl;
+}
+
+void test_kmer_in_filters() {
+  using Kmer = PackedKmer<64>;
+  using KmerCuckooFilter =
+      CuckooFilter<uint16_t, Kmer, Table<uint16_t>, KmerHash>;
+  using KmerDynamicCuckooFilter =
+      DynamicCuckooFilter<uint16_t, Kmer, Table<uint16_t>, KmerHash>;
+  std::unique_ptr<KmerCuckooFilter> cf =
+      std::make_unique<KmerCuckooFilter>(1000);
+  std::unique_ptr<KmerDynamicCuckooFilter> dcf =
+      std::make_unique<KmerDynamicCuckooFilter>(256);
+
+  std::vector<Kmer> kmers;
+  for (int i = 0; i < 500; i++) kmers.push_back(Kmer(generateKMer(50)));
+
+  for (const Kmer &kmer : kmers) {
+    assert(cf->Add(kmer) == Ok);
+    assert(dcf->Add(kmer) == Ok);
+  }
+  for (const Kmer &kmer : kmers) {
+    assert(cf->Contain(kmer) == Ok);
+    assert(dcf->Contains(kmer) == Ok);
+  }
+  for (const Kmer &kmer : kmers) {
+    assert(cf->Delete(kmer) == Ok);
+    assert(dcf->Delete(kmer) == Ok);
+  }
+  assert(cf->Size() == 0);
+  assert(dcf->TotalSize() == 0);
+
+  std::cout << "PASS test_kmer_in_filters" << std::endl;
+}
+
+int main(int argc, const char *argv[]) {
+  test_pack_unpack();
+  test_invalid_kmer();
+  test_compare_kmer();
+  test_hash_kmer();
+  test_kmer_in_filters();
+
+  return 0;
+}
@@ -0,0 +1,76 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "../src/cuckoofilter.h"
+
+using namespace cuckoofilterbio1;
+
+uint64_t NowNanos() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// testBitsPerItem fills a CF with table_type to 95% and prints the memory
+// used per stored item, the false positive rate and the average time of
+// Contain for added items (hits) and for other items (misses)
+template <class table_type>
+void testBitsPerItem(const char *name, const size_t max_items) {
+  using Filter = CuckooFilter<uint32_t, uint64_t, table_type>;
+  std::unique_ptr<Filter> cf = std::make_unique<Filter>(max_items);
+  const uint64_t negative_offset = 1ULL << 40;
+  const size_t lookups = 4 * max_items;
+
+  uint64_t added = 0;
+  while (added < 0.95 * max_items && cf->Add(added) == Ok) added++;
+
+  size_t found_count = 0;
+  uint64_t start_time = NowNanos();
+  for (size_t i = 0; i < lookups; i++)
+    found_count += cf->Contain((uint64_t)(i % added)) == Ok;
+  uint64_t hit_time = NowNanos() - start_time;
+
+  size_t false_positive_count = 0;
+  start_time = NowNanos();
+  for (size_t i = 0; i < lookups; i++)
+    false_positive_count += cf->Contain(negative_offset + i) == Ok;
+  uint64_t miss_time = NowNanos() - start_time;
+
+  std::cout << std::setw(20) << name << std::fixed << std::setprecision(4)
+            << std::setw(10) << cf->LoadFactor() << std::setw(11)
+            << cf->BitsPerItem() << std::setw(11)
+            << (100. * false_positive_count) / lookups << "%"
+            << std::setprecision(2) << std::setw(10)
+            << (1. * hit_time) / lookups << std::setw(10)
+            << (1. * miss_time) / lookups << "  (" << found_count << ")"
+            << std::endl;
+}
+
+int main(int argc, const char *argv[]) {
+  std::srand(987654321);
+
+  size_t max_items = 1 << 22;
+  if (argc > 1) max_items = std::stoul(argv[1]);
+
+  std::cout << "max_items = " << max_items << std::endl;
+  std::cout << std::setw(20) << "table" << std::setw(10) << "load"
+            << std::setw(11) << "bits/item" << std::setw(12) << "FPP"
+            << std::setw(10) << "hit ns" << std::setw(10) << "miss ns"
+            << std::endl;
+
+  testBitsPerItem<Table<uint8_t>>("Table<uint8_t>", max_items);
+  testBitsPerItem<PackedTable<8>>("PackedTable<8>", max_items);
+  testBitsPerItem<PackedTable<9>>("PackedTable<9>", max_items);
+  testBitsPerItem<BitPackedTable<12>>("BitPackedTable<12>", max_items);
+  testBitsPerItem<PackedTable<12>>("PackedTable<12>", max_items);
+  testBitsPerItem<PackedTable<13>>("PackedTable<13>", max_items);
+  testBitsPerItem<Table<uint16_t>>("Table<uint16_t>", max_items);
+  testBitsPerItem<PackedTable<16>>("PackedTable<16>", max_items);
+
+  return 0;
+}
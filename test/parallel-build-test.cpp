@@ -0,0 +1,67 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../src/dynamic-cuckoofilter.h"
+
+using namespace cuckoofilterbio1;
+
+uint64_t NowNanos() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// testParallelBuild builds a filter made with max_items from keys with 1, 2,
+// 4, ... up to max_threads threads and prints time per key and the speedup
+// over one thread
+template <class filter_type>
+void testParallelBuild(const char *name, const size_t max_items,
+                       const std::vector<uint64_t> &keys,
+                       const size_t max_threads) {
+  std::cout << name << std::endl;
+  double single_thread_time = 0;
+
+  for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+    std::unique_ptr<filter_type> filter =
+        std::make_unique<filter_type>(max_items);
+    uint64_t start_time = NowNanos();
+    Status status = filter->Build(keys, threads);
+    double build_time = NowNanos() - start_time;
+    if (threads == 1) single_thread_time = build_time;
+
+    std::cout << std::setw(10) << threads << " threads" << std::fixed
+              << std::setprecision(2) << std::setw(10)
+              << build_time / keys.size() << " ns/key" << std::setw(10)
+              << single_thread_time / build_time << "x"
+              << (status == Ok ? "" : "  (not all keys added)") << std::endl;
+  }
+}
+
+int main(int argc, const char *argv[]) {
+  size_t max_items = 1 << 26;
+  if (argc > 1) max_items = std::stoul(argv[1]);
+  size_t max_threads = std::thread::hardware_concurrency();
+  if (argc > 2) max_threads = std::stoul(argv[2]);
+
+  std::vector<uint64_t> keys(0.9 * max_items);
+  for (size_t i = 0; i < keys.size(); i++) keys[i] = i * 0x9e3779b97f4a7c15ULL;
+
+  std::cout << "max_items = " << max_items << ", " << keys.size()
+            << " keys, up to " << max_threads << " threads" << std::endl;
+  testParallelBuild<CuckooFilter<uint16_t, uint64_t>>(
+      "CuckooFilter<uint16_t>", max_items, keys, max_threads);
+  testParallelBuild<CuckooFilter<uint16_t, uint64_t, BitPackedTable<12>>>(
+      "CuckooFilter<BitPackedTable<12>>", max_items, keys, max_threads);
+  testParallelBuild<DynamicCuckooFilter<uint16_t, uint64_t>>(
+      "DynamicCuckooFilter<uint16_t>, 16 CFs", max_items / 16, keys,
+      max_threads);
+
+  return 0;
+}
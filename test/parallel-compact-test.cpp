@@ -0,0 +1,64 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+#include "../src/dynamic-cuckoofilter.h"
+
+using namespace cuckoofilterbio1;
+
+uint64_t NowNanos() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// testParallelCompact fills levels levels of items items each, deletes
+// every other key so all levels are half empty and compacts the DCF with
+// num_threads threads. It prints the time of Compact, the speedup over
+// single_time (if set) and the number of levels left. Returns the time.
+double testParallelCompact(const size_t items, const size_t levels,
+                           const size_t num_threads,
+                           const double single_time) {
+  const size_t count = levels * items * 0.9;
+  using Filter = DynamicCuckooFilter<uint16_t, uint64_t>;
+
+  std::unique_ptr<Filter> dcf = std::make_unique<Filter>(items);
+  for (uint64_t i = 0; i < count; i++) dcf->Add(i);
+  for (uint64_t i = 1; i < count; i += 2) dcf->Delete(i);
+
+  uint64_t start_time = NowNanos();
+  dcf->Compact(num_threads);
+  double time = (NowNanos() - start_time) / 1e6;
+
+  std::cout << std::setw(8) << num_threads << std::fixed
+            << std::setprecision(2) << std::setw(12) << time << std::setw(10)
+            << (single_time > 0 ? single_time / time : 1) << std::setw(8)
+            << dcf->SizeOfEachCF().size() << std::endl;
+  return time;
+}
+
+int main(int argc, char *argv[]) {
+  const size_t items = argc > 1 ? atoll(argv[1]) : 1 << 16;
+  const size_t levels = argc > 2 ? atoll(argv[2]) : 64;
+
+  const unsigned hardware_threads = std::thread::hardware_concurrency();
+  std::cout << "hardware threads: " << hardware_threads
+            << ", levels before: " << levels << std::endl;
+  if (hardware_threads < 2)
+    std::cout << "with one hardware thread the threads take turns, so the "
+                 "speedup shows only their overhead"
+              << std::endl;
+  std::cout << std::setw(8) << "threads" << std::setw(12) << "ms"
+            << std::setw(10) << "speedup" << std::setw(8) << "after"
+            << std::endl;
+
+  const double single_time = testParallelCompact(items, levels, 1, 0);
+  for (size_t num_threads : {2, 4, 8, 16}) {
+    testParallelCompact(items, levels, num_threads, single_time);
+  }
+  return 0;
+}
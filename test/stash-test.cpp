@@ -0,0 +1,64 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+
+#include "../src/dynamic-cuckoofilter.h"
+
+using namespace cuckoofilterbio1;
+
+uint64_t NowNanos() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// testStash adds keys to a CuckooFilter with stash_size stash slots until
+// the first NotEnoughSpace and to a DynamicCuckooFilter with threshold 1,
+// then prints the load factor of the CF, the number and average load of
+// the DCF levels and the average time of lookups that miss
+template <class table_type>
+void testStash(const char *name, const size_t items, const size_t stash_size) {
+  const size_t count = 8 * items;
+  const size_t lookups = 1 << 22;
+  const uint64_t negative_offset = 1ULL << 40;
+
+  using Filter = CuckooFilter<uint16_t, uint64_t, table_type>;
+  std::unique_ptr<Filter> cf = std::make_unique<Filter>(items, 0, stash_size);
+  for (uint64_t i = 0; cf->Add(i) == Ok; i++) continue;
+
+  using Dynamic = DynamicCuckooFilter<uint16_t, uint64_t, table_type>;
+  std::unique_ptr<Dynamic> dcf =
+      std::make_unique<Dynamic>(items, 1, stash_size);
+  for (uint64_t i = 0; i < count; i++) dcf->Add(i);
+  const size_t levels = dcf->SizeOfEachCF().size();
+
+  size_t found = 0;
+  uint64_t start_time = NowNanos();
+  for (uint64_t i = 0; i < lookups; i++)
+    found += dcf->Contains(negative_offset + i) == Ok;
+  double miss_time = 1. * (NowNanos() - start_time) / lookups;
+
+  std::cout << std::setw(16) << name << std::setw(8) << stash_size
+            << std::fixed << std::setprecision(4) << std::setw(12)
+            << cf->LoadFactor() << std::setw(10) << levels << std::setw(12)
+            << 1. * count / (levels * items) << std::setprecision(2)
+            << std::setw(10) << miss_time << "  (" << found << ")"
+            << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+  const size_t items = argc > 1 ? atoll(argv[1]) : 1 << 16;
+
+  std::cout << std::setw(16) << "table" << std::setw(8) << "stash"
+            << std::setw(12) << "CF load" << std::setw(10) << "levels"
+            << std::setw(12) << "DCF load" << std::setw(10) << "miss ns"
+            << std::endl;
+  for (size_t stash_size : {1, 4, 8, 16, 64}) {
+    testStash<Table<uint16_t, 2>>("2-way", items, stash_size);
+    testStash<Table<uint16_t>>("4-way", items, stash_size);
+  }
+  return 0;
+}
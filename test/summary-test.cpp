@@ -0,0 +1,82 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+
+#include "../src/dynamic-cuckoofilter.h"
+
+using namespace cuckoofilterbio1;
+
+uint64_t NowNanos() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// testChurn fills levels levels of items items each in a DCF that keeps the
+// level summary if keep_summary is true, deletes all but one in keep_every
+// added keys and, if compact is true, compacts the DCF. Then it prints the
+// average times of adding, of lookups of kept keys (hits) and of other keys
+// (misses)
+void testChurn(const size_t items, const size_t levels,
+               const size_t keep_every, const bool compact,
+               const bool keep_summary) {
+  const size_t count = levels * items * 0.9;
+  const size_t lookups = 1 << 21;
+  const uint64_t negative_offset = 1ULL << 40;
+  using Filter = DynamicCuckooFilter<uint16_t, uint64_t>;
+
+  std::unique_ptr<Filter> dcf = std::make_unique<Filter>(
+      items, 0.9, default_stash_size, LevelGrowth(), keep_summary);
+  uint64_t start_time = NowNanos();
+  for (uint64_t i = 0; i < count; i++) dcf->Add(i);
+  double add_time = 1. * (NowNanos() - start_time) / count;
+
+  for (uint64_t i = 0; i < count; i++)
+    if (i % keep_every != 0) dcf->Delete(i);
+  if (compact) dcf->Compact();
+
+  size_t found = 0;
+  start_time = NowNanos();
+  for (uint64_t i = 0; i < lookups; i++)
+    found += dcf->Contains((i * 2654435761u) % count / keep_every *
+                           keep_every) == Ok;
+  double hit_time = 1. * (NowNanos() - start_time) / lookups;
+  start_time = NowNanos();
+  for (uint64_t i = 0; i < lookups; i++)
+    found += dcf->Contains(negative_offset + i) == Ok;
+  double miss_time = 1. * (NowNanos() - start_time) / lookups;
+
+  std::cout << std::setw(8) << levels << std::setw(8) << keep_every
+            << std::setw(9) << (compact ? "yes" : "no") << std::setw(9)
+            << (keep_summary ? "yes" : "no") << std::setw(8)
+            << dcf->SizeOfEachCF().size() << std::fixed << std::setprecision(2)
+            << std::setw(10) << add_time
+            << std::setw(10) << hit_time << std::setw(10) << miss_time
+            << "  (" << found << ")" << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+  const size_t items = argc > 1 ? atoll(argv[1]) : 1 << 16;
+
+  std::cout << std::setw(8) << "levels" << std::setw(8) << "keep"
+            << std::setw(9) << "compact" << std::setw(9) << "summary"
+            << std::setw(8) << "after"
+            << std::setw(10) << "add ns" << std::setw(10) << "hit ns"
+            << std::setw(10) << "miss ns" << std::endl;
+  const size_t only_levels = argc > 2 ? atoll(argv[2]) : 0;
+
+  for (size_t levels : {20, 50}) {
+    if (only_levels != 0 && levels != only_levels) continue;
+    for (bool keep_summary : {false, true}) {
+      testChurn(items, levels, 1, false, keep_summary);
+      for (size_t keep_every : {4, 16}) {
+        testChurn(items, levels, keep_every, false, keep_summary);
+        testChurn(items, levels, keep_every, true, keep_summary);
+      }
+    }
+  }
+  return 0;
+}
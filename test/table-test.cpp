@@ -2,8 +2,10 @@
 
 #include <assert.h>
 
+#include <algorithm>
 #include <iostream>
 #include <memory>
+#include <vector>
 
 using namespace cuckoofilterbio1;
 
@@ -109,6 +111,257 @@ void test_insert_item_with_kickout_table() {
   std::cout << "PASS test_insert_item_with_kickout_table" << std::endl;
 }
 
+// every slot of a BitPackedTable keeps its own value, writes do not change
+// neighbouring slots
+template <size_t bits>
+void test_bit_packed_table() {
+  const size_t bucket_count = 37;
+  const uint32_t mask = (uint32_t)((1ULL << bits) - 1);
+  std::unique_ptr<BitPackedTable<bits>> table =
+      std::make_unique<BitPackedTable<bits>>(bucket_count);
+  std::vector<uint32_t> expected(bucket_count * 4);
+
+  assert(table->SizeInBytes() == (bucket_count * 4 * bits + 7) / 8);
+  for (int round = 0; round < 3; round++) {
+    for (size_t i = 0; i < bucket_count; ++i) {
+      for (size_t j = 0; j < 4; ++j) {
+        expected[i * 4 + j] = (rand() * 2654435761u) & mask;
+        table->WriteItem(i, j, expected[i * 4 + j]);
+      }
+    }
+    for (size_t i = 0; i < bucket_count; ++i) {
+      for (size_t j = 0; j < 4; ++j) {
+        assert(table->ReadItem(i, j) == expected[i * 4 + j]);
+      }
+    }
+  }
+
+  for (size_t i = 0; i < bucket_count; ++i) {
+    for (size_t j = 0; j < 4; ++j) {
+      table->WriteItem(i, j, 0);
+    }
+  }
+  uint32_t old_fingerprint;
+  uint32_t fingerprint = mask;
+  for (int j = 0; j < 4; j++) {
+    assert(table->InsertItemToBucket(3, fingerprint - j, false,
+                                     old_fingerprint));
+  }
+  assert(!table->InsertItemToBucket(3, 1, false, old_fingerprint));
+  assert(table->GetBucket(2).empty() && table->GetBucket(4).empty());
+  assert(table->FindFingerprintInBuckets(0, 3, fingerprint - 2));
+  assert(!table->FindFingerprintInBuckets(2, 4, fingerprint - 2));
+  assert(table->DeleteItemFromBucket(3, fingerprint - 2));
+  assert(!table->FindFingerprintInBuckets(0, 3, fingerprint - 2));
+  assert(table->GetBucket(3).size() == 3);
+
+  std::cout << "PASS test_bit_packed_table<" << bits << ">" << std::endl;
+}
+
+// simd kernels must give the same answer as a plain loop over the slots
+template <typename uintx, size_t slots>
+void test_simd_kernels() {
+  uintx bucket1[slots], bucket2[slots];
+
+  for (int round = 0; round < 10000; round++) {
+    // small values so that matches and empty slots are common, every other
+    // round values have the high bit of a byte set
+    const uint32_t base = (round & 1) * 250;
+    for (size_t j = 0; j < slots; j++) {
+      bucket1[j] = rand() % 8 == 0 ? 0 : (uintx)(rand() % 6 + base);
+      bucket2[j] = rand() % 8 == 0 ? 0 : (uintx)(rand() % 6 + base);
+    }
+    uint32_t value = rand() % 2 ? 0 : (uintx)(rand() % 6 + base);
+
+    int expected_slot = -1;
+    bool expected_found = false;
+    for (size_t j = 0; j < slots; j++) {
+      if (bucket1[j] == value && expected_slot < 0) expected_slot = j;
+      if (bucket1[j] == value || bucket2[j] == value) expected_found = true;
+    }
+
+    assert((simd::FindSlot<uintx, slots>(bucket1, value)) == expected_slot);
+    assert((simd::FindInBuckets<uintx, slots>(bucket1, bucket2, value)) ==
+           expected_found);
+  }
+
+  std::cout << "PASS test_simd_kernels<" << sizeof(uintx) * 8 << ", " << slots
+            << ">" << std::endl;
+}
+
+// FindInArray finds the first match in arrays of any length, including the
+// parts that do not fill a whole SIMD register
+template <typename uintx>
+void test_find_in_array() {
+  uintx values[96];
+
+  for (int round = 0; round < 10000; round++) {
+    const size_t count = rand() % 97;
+    for (size_t i = 0; i < count; i++)
+      values[i] = rand() % 8 == 0 ? 0 : (uintx)(rand() % 40 + 1);
+    uint32_t value = rand() % 4 == 0 ? 0 : (uintx)(rand() % 40 + 1);
+
+    long expected = -1;
+    for (size_t i = 0; i < count && expected < 0; i++)
+      if (values[i] == value) expected = i;
+
+    assert(simd::FindInArray(values, count, value) == expected);
+  }
+
+  std::cout << "PASS test_find_in_array<" << sizeof(uintx) * 8 << ">"
+            << std::endl;
+}
+
+void test_semi_sort_codes() {
+  const packeddetail::SemiSortCodes& codes = packeddetail::Codes();
+  std::vector<bool> used(packeddetail::k_code_count, false);
+
+  for (uint32_t a = 0; a < 16; a++)
+    for (uint32_t b = a; b < 16; b++)
+      for (uint32_t c = b; c < 16; c++)
+        for (uint32_t d = c; d < 16; d++) {
+          uint32_t code = codes.Encode(a, b, c, d);
+          assert(code < packeddetail::k_code_count && !used[code]);
+          used[code] = true;
+          assert(codes.Decode(code) == (a | b << 4 | c << 8 | d << 12));
+        }
+  assert(codes.Encode(0, 0, 0, 0) == 0);
+
+  std::cout << "PASS test_semi_sort_codes" << std::endl;
+}
+
+// buckets of a PackedTable hold the same multiset of fingerprints that was
+// written, and writing one bucket does not change its neighbours
+template <size_t bits>
+void test_packed_table() {
+  const size_t bucket_count = 37;
+  const uint32_t mask = (uint32_t)((1ULL << bits) - 1);
+  std::unique_ptr<PackedTable<bits>> table =
+      std::make_unique<PackedTable<bits>>(bucket_count);
+  std::vector<std::vector<uint32_t>> expected(bucket_count);
+  uint32_t old_fingerprint;
+
+  assert(table->SizeInBytes() == (bucket_count * (4 * bits - 4) + 7) / 8);
+  for (int round = 0; round < 3; round++) {
+    for (size_t i = 0; i < bucket_count; ++i) {
+      for (uint32_t fingerprint : expected[i])
+        assert(table->DeleteItemFromBucket(i, fingerprint));
+      assert(table->GetBucket(i).empty());
+
+      expected[i].clear();
+      size_t count = rand() % 5;
+      for (size_t j = 0; j < count; ++j) {
+        // repeat prefixes and whole fingerprints now and then
+        uint32_t fingerprint = j > 0 && rand() % 4 == 0
+                                   ? expected[i][0] ^ (rand() % 2 << 4)
+                                   : (rand() * 2654435761u) & mask;
+        if (fingerprint == 0) fingerprint = 1;
+        expected[i].push_back(fingerprint);
+        assert(table->InsertItemToBucket(i, fingerprint, false,
+                                         old_fingerprint));
+      }
+      std::sort(expected[i].begin(), expected[i].end());
+    }
+    for (size_t i = 0; i < bucket_count; ++i) {
+      std::vector<uint32_t> bucket = table->GetBucket(i);
+      std::sort(bucket.begin(), bucket.end());
+      assert(bucket == expected[i]);
+      for (uint32_t fingerprint : expected[i]) {
+        assert(table->FindFingerprintInBuckets(0, i, fingerprint));
+        // same suffix with another prefix
+        uint32_t other = fingerprint ^ 1;
+        if (other != 0 &&
+            std::count(expected[i].begin(), expected[i].end(), other) == 0)
+          assert(!table->FindFingerprintInBuckets(i, i, other));
+      }
+    }
+  }
+
+  std::cout << "PASS test_packed_table<" << bits << ">" << std::endl;
+}
+
+// a bucket holds exactly table_type::k_items_per_bucket fingerprints
+template <class table_type>
+void test_items_per_bucket(const char* name) {
+  const size_t slots = table_type::k_items_per_bucket;
+  const uint32_t fingerprint = (1ULL << table_type::k_bits_per_item) - 1;
+  std::unique_ptr<table_type> table = std::make_unique<table_type>(5);
+  uint32_t old_fingerprint;
+
+  assert(table->SizeTable() == slots * 5);
+  for (uint32_t j = 0; j < slots; j++) {
+    assert(table->InsertItemToBucket(2, fingerprint - j, false,
+                                     old_fingerprint));
+  }
+  assert(!table->InsertItemToBucket(2, 1, false, old_fingerprint));
+  assert(table->GetBucket(1).empty() && table->GetBucket(3).empty());
+  assert(table->GetBucket(2).size() == slots);
+  assert(table->FindFingerprintInBuckets(0, 2, fingerprint - (slots - 1)));
+  assert(!table->FindFingerprintInBuckets(1, 3, fingerprint));
+
+  assert(!table->InsertItemToBucket(2, 1, true, old_fingerprint));
+  assert(old_fingerprint > fingerprint - slots);
+  assert(table->FindFingerprintInBuckets(2, 2, 1));
+  assert(table->DeleteItemFromBucket(2, 1));
+  assert(table->GetBucket(2).size() == slots - 1);
+
+  std::cout << "PASS test_items_per_bucket<" << name << ">" << std::endl;
+}
+
+// allocator policies return zeroed memory aligned to at least `alignment`,
+// and a Table using them starts empty
+template <class allocator_type>
+void test_allocator(const char* name, const size_t alignment) {
+  for (size_t bytes : {0, 1, 100, 4096, 3 << 20}) {
+    uint8_t* p = static_cast<uint8_t*>(allocator_type::Allocate(bytes));
+    assert((uintptr_t)p % alignment == 0);
+    for (size_t i = 0; i < bytes; i++) assert(p[i] == 0);
+    memset(p, 0xff, bytes);
+    allocator_type::Deallocate(p, bytes);
+  }
+
+  const size_t bucket_count = 1 << 20;
+  std::unique_ptr<Table<uint16_t, 4, allocator_type>> table =
+      std::make_unique<Table<uint16_t, 4, allocator_type>>(bucket_count);
+  uint32_t old_fingerprint;
+  for (size_t i = 0; i < bucket_count; i += 997) {
+    assert(table->GetBucket(i).empty());
+    assert(table->InsertItemToBucket(i, (i & 0xffff) | 1, false,
+                                     old_fingerprint));
+  }
+  for (size_t i = 0; i < bucket_count; i += 997)
+    assert(table->FindFingerprintInBuckets(i, i, (i & 0xffff) | 1));
+
+  std::cout << "PASS test_allocator<" << name << ">" << std::endl;
+}
+
+// an alignment asked for when allocating overrides a smaller one of the
+// allocator, and the tables can be created with one (see BlockedLayout)
+void test_alignment() {
+  for (size_t alignment : {128, 4096, 1 << 16}) {
+    void* p = AlignedAllocator<>::Allocate(100, alignment);
+    assert((uintptr_t)p % alignment == 0);
+    AlignedAllocator<>::Deallocate(p, 100);
+  }
+
+  Table<uint16_t> table(1 << 10, 4096);
+  BitPackedTable<12> bit_packed(1 << 10, 4096);
+  PackedTable<13> packed(1 << 10, 4096);
+  uint32_t old_fingerprint;
+  for (uint32_t i = 0; i < 1 << 10; i++) {
+    assert(table.InsertItemToBucket(i, i | 1, false, old_fingerprint));
+    assert(bit_packed.InsertItemToBucket(i, i | 1, false, old_fingerprint));
+    assert(packed.InsertItemToBucket(i, i | 1, false, old_fingerprint));
+  }
+  for (uint32_t i = 0; i < 1 << 10; i++) {
+    assert(table.FindFingerprintInBuckets(i, i, i | 1));
+    assert(bit_packed.FindFingerprintInBuckets(i, i, i | 1));
+    assert(packed.FindFingerprintInBuckets(i, i, i | 1));
+  }
+
+  std::cout << "PASS test_alignment" << std::endl;
+}
+
 int main(int argc, const char* argv[]) {
   test_construct_table();
   test_add_items_table();
@@ -116,6 +369,55 @@ int main(int argc, const char* argv[]) {
   test_delete_item_table();
   test_find_fingerprints_in_buckets_table();
   test_insert_item_with_kickout_table();
+  test_bit_packed_table<4>();
+  test_bit_packed_table<5>();
+  test_bit_packed_table<7>();
+  test_bit_packed_table<12>();
+  test_bit_packed_table<13>();
+  test_bit_packed_table<14>();
+  test_bit_packed_table<15>();
+  test_bit_packed_table<17>();
+  test_bit_packed_table<24>();
+  test_bit_packed_table<31>();
+  test_bit_packed_table<32>();
+  test_simd_kernels<uint8_t, 2>();
+  test_simd_kernels<uint8_t, 4>();
+  test_simd_kernels<uint8_t, 8>();
+  test_simd_kernels<uint8_t, 16>();
+  test_simd_kernels<uint16_t, 2>();
+  test_simd_kernels<uint16_t, 4>();
+  test_simd_kernels<uint16_t, 8>();
+  test_simd_kernels<uint16_t, 16>();
+  test_simd_kernels<uint32_t, 2>();
+  test_simd_kernels<uint32_t, 4>();
+  test_simd_kernels<uint32_t, 8>();
+  test_simd_kernels<uint32_t, 16>();
+  test_find_in_array<uint8_t>();
+  test_find_in_array<uint16_t>();
+  test_find_in_array<uint32_t>();
+  test_items_per_bucket<Table<uint8_t, 2>>("Table<uint8_t, 2>");
+  test_items_per_bucket<Table<uint8_t, 8>>("Table<uint8_t, 8>");
+  test_items_per_bucket<Table<uint8_t, 16>>("Table<uint8_t, 16>");
+  test_items_per_bucket<Table<uint16_t, 2>>("Table<uint16_t, 2>");
+  test_items_per_bucket<Table<uint16_t, 8>>("Table<uint16_t, 8>");
+  test_items_per_bucket<Table<uint32_t, 16>>("Table<uint32_t, 16>");
+  test_items_per_bucket<BitPackedTable<7, 2>>("BitPackedTable<7, 2>");
+  test_items_per_bucket<BitPackedTable<12, 8>>("BitPackedTable<12, 8>");
+  test_items_per_bucket<BitPackedTable<13, 16>>("BitPackedTable<13, 16>");
+  test_semi_sort_codes();
+  test_packed_table<5>();
+  test_packed_table<7>();
+  test_packed_table<8>();
+  test_packed_table<12>();
+  test_packed_table<13>();
+  test_packed_table<16>();
+  test_items_per_bucket<PackedTable<9>>("PackedTable<9>");
+  test_items_per_bucket<PackedTable<16>>("PackedTable<16>");
+  test_allocator<AlignedAllocator<>>("AlignedAllocator<>", 64);
+  test_allocator<AlignedAllocator<4096>>("AlignedAllocator<4096>", 4096);
+  test_allocator<MmapAllocator<false>>("MmapAllocator<false>", 4096);
+  test_allocator<MmapAllocator<true>>("MmapAllocator<true>", 4096);
+  test_alignment();
 
   return 0;
 }
\ No newline at end of file